@@ -0,0 +1,84 @@
+#ifndef SSC_BLOCK_SUMMARY_H_
+#define SSC_BLOCK_SUMMARY_H_
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include <voxblox/core/block.h>
+
+#include "ssc_mapping/core/voxel.h"
+
+namespace voxblox {
+
+/**
+ * Small per block summary of the SSC voxels. Maintained incrementally by the
+ * fusion so that whole map passes can skip blocks without touching voxels.
+ */
+struct SSCBlockSummary {
+    // number of semantic classes, matches SSCColorMap
+    static constexpr int kNumLabels = 13;
+
+    uint32_t num_observed = 0u;
+    uint32_t num_occupied = 0u;
+    uint32_t num_free = 0u;
+
+    // observed voxels per label
+    std::array<uint32_t, kNumLabels> label_histogram{};
+
+    // bounds of the log odds of observed voxels. Removing a voxel does not shrink
+    // the bounds, so they can be loose until the summary is recomputed.
+    float min_probability_log = std::numeric_limits<float>::max();
+    float max_probability_log = std::numeric_limits<float>::lowest();
+
+    static bool isOccupied(const SSCOccupancyVoxel& voxel) { return voxel.probability_log > 0.0f; }
+
+    void addVoxel(const SSCOccupancyVoxel& voxel) {
+        if (!voxel.observed) {
+            return;
+        }
+        ++num_observed;
+        if (isOccupied(voxel)) {
+            ++num_occupied;
+        } else {
+            ++num_free;
+        }
+        if (voxel.label >= 0 && voxel.label < kNumLabels) {
+            ++label_histogram[voxel.label];
+        }
+        min_probability_log = std::min(min_probability_log, voxel.probability_log);
+        max_probability_log = std::max(max_probability_log, voxel.probability_log);
+    }
+
+    void removeVoxel(const SSCOccupancyVoxel& voxel) {
+        if (!voxel.observed) {
+            return;
+        }
+        --num_observed;
+        if (isOccupied(voxel)) {
+            --num_occupied;
+        } else {
+            --num_free;
+        }
+        if (voxel.label >= 0 && voxel.label < kNumLabels) {
+            --label_histogram[voxel.label];
+        }
+    }
+
+    bool hasObserved() const { return num_observed > 0u; }
+    bool hasOccupied() const { return num_occupied > 0u; }
+    bool hasFree() const { return num_free > 0u; }
+};
+
+// Recomputes the summary of a block from its voxels, the log odds bounds are exact afterwards.
+inline SSCBlockSummary computeBlockSummary(const Block<SSCOccupancyVoxel>& block) {
+    SSCBlockSummary summary;
+    for (size_t linear_index = 0u; linear_index < block.num_voxels(); ++linear_index) {
+        summary.addVoxel(block.getVoxelByLinearIndex(linear_index));
+    }
+    return summary;
+}
+
+}  // namespace voxblox
+
+#endif  // SSC_BLOCK_SUMMARY_H_
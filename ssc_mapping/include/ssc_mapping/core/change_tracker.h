@@ -0,0 +1,86 @@
+#ifndef SSC_CHANGE_TRACKER_H_
+#define SSC_CHANGE_TRACKER_H_
+
+#include <functional>
+#include <map>
+#include <vector>
+
+#include <voxblox/core/block_hash.h>
+#include <voxblox/core/common.h>
+
+namespace voxblox {
+
+/**
+ * Blocks modified by a single integration (or load/clear) of the SSC map.
+ */
+struct SSCChangeSet {
+    // version of the map after the change was applied
+    uint64_t map_version = 0u;
+
+    // all blocks were removed before the listed blocks were modified
+    bool map_reset = false;
+
+    // indices of the modified blocks
+    BlockIndexList blocks;
+
+    // optional masks of the modified voxels per block, indexed by the linear voxel index.
+    // Only filled if voxel tracking is enabled.
+    AnyIndexHashMapType<std::vector<bool>>::type voxel_masks;
+};
+
+/**
+ * Collects the blocks modified during an integration, assigns monotonically
+ * increasing map and block versions on commit and notifies in-process listeners
+ * with the resulting change-set.
+ */
+class SSCChangeTracker {
+   public:
+    typedef std::function<void(const SSCChangeSet&)> Listener;
+    typedef size_t ListenerId;
+
+    explicit SSCChangeTracker(bool track_voxels = false) : track_voxels_(track_voxels) {}
+
+    void setTrackVoxels(bool track_voxels) { track_voxels_ = track_voxels; }
+    bool isTrackingVoxels() const { return track_voxels_; }
+
+    // marks a block as modified in the pending change-set
+    void markBlock(const BlockIndex& block_index) { pending_blocks_.insert(block_index); }
+
+    // marks a single voxel as modified, only recorded if voxel tracking is enabled
+    void markVoxel(const BlockIndex& block_index, size_t linear_index, size_t num_voxels);
+
+    // marks that all blocks were removed, e.g. on clear or before loading a map
+    void markReset();
+
+    bool hasPendingChanges() const { return map_reset_pending_ || !pending_blocks_.empty(); }
+
+    // turns the pending changes into a change-set, bumps the map version and notifies
+    // all listeners. Returns the new map version.
+    uint64_t commit();
+
+    uint64_t getMapVersion() const { return map_version_; }
+
+    // version at which a block was last modified, 0 if it never was
+    uint64_t getBlockVersion(const BlockIndex& block_index) const;
+
+    // lists the blocks modified after the given map version
+    void getBlocksModifiedSince(uint64_t map_version, BlockIndexList* blocks) const;
+
+    ListenerId addListener(const Listener& listener);
+    void removeListener(ListenerId listener_id);
+
+   private:
+    bool track_voxels_;
+    bool map_reset_pending_ = false;
+    uint64_t map_version_ = 0u;
+    IndexSet pending_blocks_;
+    AnyIndexHashMapType<std::vector<bool>>::type pending_voxel_masks_;
+    AnyIndexHashMapType<uint64_t>::type block_versions_;
+
+    ListenerId next_listener_id_ = 0u;
+    std::map<ListenerId, Listener> listeners_;
+};
+
+}  // namespace voxblox
+
+#endif  // SSC_CHANGE_TRACKER_H_
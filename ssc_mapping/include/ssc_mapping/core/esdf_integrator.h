@@ -0,0 +1,75 @@
+#ifndef SSC_ESDF_INTEGRATOR_H_
+#define SSC_ESDF_INTEGRATOR_H_
+
+#include <deque>
+
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+
+#include "ssc_mapping/core/voxel.h"
+
+namespace voxblox {
+
+/**
+ * Euclidean distance field of the occupied voxels of an SSC layer, up to
+ * max_distance. Every voxel remembers its nearest occupied voxel (site), so
+ * the field can be updated incrementally from the changed SSC blocks: voxels
+ * that became occupied start a lowering wave, voxels that were freed clear
+ * all voxels pointing to them (raise) and the boundary of the cleared region
+ * propagates its sites back in.
+ *
+ * Distances are to occupied voxels only, unobserved space counts as free.
+ * Voxels without an occupied voxel within max_distance, including those
+ * in blocks that are not allocated, are reported at max_distance.
+ */
+class SSCEsdfIntegrator {
+   public:
+    struct Config {
+        // distances are only propagated up to here
+        FloatingPoint max_distance = 2.0f;
+        // SSC voxels with larger log odds are obstacles
+        float occupied_log_odds = 0.0f;
+    };
+
+    SSCEsdfIntegrator(const Config& config, const Layer<SSCOccupancyVoxel>& ssc_layer,
+                      Layer<SSCEsdfVoxel>* esdf_layer);
+
+    // updates the field after the given SSC blocks changed
+    void updateFromSSCBlocks(const BlockIndexList& blocks);
+
+    // rebuilds the field from all blocks of the SSC layer
+    void updateFromSSCLayer();
+
+    void clear() { esdf_layer_->removeAllBlocks(); }
+
+    const Config& getConfig() const { return config_; }
+    const Layer<SSCEsdfVoxel>& getEsdfLayer() const { return *esdf_layer_; }
+
+    // distance to the nearest occupied voxel, max_distance if none is closer
+    FloatingPoint getDistance(const GlobalIndex& global_index) const;
+    FloatingPoint getDistanceAtPosition(const Point& position) const;
+
+   private:
+    SSCEsdfVoxel* getVoxel(const GlobalIndex& global_index) const;
+    SSCEsdfVoxel* getOrAllocateVoxel(const GlobalIndex& global_index);
+    Block<SSCEsdfVoxel>::Ptr allocateBlock(const BlockIndex& block_index);
+
+    void resetVoxel(SSCEsdfVoxel* voxel) const;
+    void processRaiseQueue();
+    void processLowerQueue();
+
+    const Config config_;
+    const Layer<SSCOccupancyVoxel>& ssc_layer_;
+    Layer<SSCEsdfVoxel>* esdf_layer_;
+    const size_t voxels_per_side_;
+    const FloatingPoint voxel_size_;
+    // site offsets are stored in int8, bounding the distance in voxels
+    const LongIndexElement max_distance_voxels_;
+
+    std::deque<GlobalIndex> raise_queue_;
+    std::deque<GlobalIndex> lower_queue_;
+};
+
+}  // namespace voxblox
+
+#endif  // SSC_ESDF_INTEGRATOR_H_
@@ -2,16 +2,60 @@
 #ifndef SSC_MAP_H_
 #define SSC_MAP_H_
 
+#include <mutex>
+#include <shared_mutex>
+
 #include <voxblox/core/common.h>
 #include <voxblox/core/layer.h>
 #include <voxblox/core/voxel.h>
 
+#include "ssc_mapping/core/block_summary.h"
 #include "ssc_mapping/core/voxel.h"
 
 namespace voxblox {
 
+/**
+ * Reader-writer lock that does not let a stream of readers starve the writer,
+ * which std::shared_timed_mutex allows on glibc. A waiting writer holds the
+ * gate so that new readers queue up behind it.
+ */
+class SSCMapMutex {
+   public:
+    void lock() {
+        std::lock_guard<std::mutex> gate(gate_);
+        mutex_.lock();
+    }
+    bool try_lock() { return mutex_.try_lock(); }
+    void unlock() { mutex_.unlock(); }
+
+    void lock_shared() {
+        std::lock_guard<std::mutex> gate(gate_);
+        mutex_.lock_shared();
+    }
+    bool try_lock_shared() { return mutex_.try_lock_shared(); }
+    void unlock_shared() { mutex_.unlock_shared(); }
+
+   private:
+    std::mutex gate_;
+    std::shared_timed_mutex mutex_;
+};
+
+/**
+ * Layer of SSC voxels and the per block summaries.
+ *
+ * Concurrent access: the blocks and summaries are only modified by one thread,
+ * the one running the fusion or applying layer updates. It fuses into staged
+ * copies of the blocks (see SSCStagedBlocks) and holds the write lock only to
+ * swap them in. Other threads hold a read lock for every query, pointers to
+ * voxels and summaries are valid until the lock is released.
+ */
 class SSCMap {
    public:
+    typedef AnyIndexHashMapType<SSCBlockSummary>::type BlockSummaryMap;
+    typedef SSCMapMutex Mutex;
+    typedef std::shared_lock<Mutex> ReadLock;
+    typedef std::unique_lock<Mutex> WriteLock;
+
     struct Config {
         FloatingPoint ssc_voxel_size = 0.2;
         size_t ssc_voxels_per_side = 16u;
@@ -19,10 +63,13 @@ class SSCMap {
         std::string print() const;
     };
 
-    explicit SSCMap(const Config& config)
-        : ssc_layer_(new Layer<SSCOccupancyVoxel>(config.ssc_voxel_size, config.ssc_voxels_per_side)) {
-        block_size_ = config.ssc_voxel_size * config.ssc_voxels_per_side;
-    }
+    typedef const SSCOccupancyVoxel* (*VoxelLookupFunction)(const Layer<SSCOccupancyVoxel>& layer,
+                                                            const GlobalIndex& global_index);
+
+    explicit SSCMap(const Config& config);
+
+    ReadLock lockForReading() const { return ReadLock(mutex_); }
+    WriteLock lockForWriting() { return WriteLock(mutex_); }
 
     Layer<SSCOccupancyVoxel>* getSSCLayerPtr() { return ssc_layer_.get(); }
     const Layer<SSCOccupancyVoxel>* getSSCLayerConstPtr() const { return ssc_layer_.get(); }
@@ -32,8 +79,37 @@ class SSCMap {
     FloatingPoint voxel_size() const { return ssc_layer_->voxel_size(); }
     
     bool isObserved(const Eigen::Vector3d& position) const;
+
+    // voxel lookups using the index math specialized for the block size, nullptr if not allocated
+    const SSCOccupancyVoxel* getVoxelPtrByGlobalIndex(const GlobalIndex& global_index) const {
+        return voxel_lookup_fn_(*ssc_layer_, global_index);
+    }
+    const SSCOccupancyVoxel* getVoxelPtrByCoordinates(const Point& point) const {
+        return voxel_lookup_fn_(*ssc_layer_, getGridIndexFromPoint<GlobalIndex>(point, ssc_layer_->voxel_size_inv()));
+    }
+    const SSCOccupancyVoxel* getVoxelPtrByCoordinates(const Eigen::Vector3d& position) const {
+        return getVoxelPtrByCoordinates(position.cast<FloatingPoint>().eval());
+    }
+
+    // removes all blocks along with their summaries
+    void clear();
+
+    // summary of a block kept up to date by the fusion, nullptr if there is none
+    const SSCBlockSummary* getBlockSummary(const BlockIndex& block_index) const;
+    SSCBlockSummary* getBlockSummaryPtr(const BlockIndex& block_index) { return &block_summaries_[block_index]; }
+    const BlockSummaryMap& getBlockSummaries() const { return block_summaries_; }
+
+    // recomputes the summaries of all blocks, needed after the layer was filled without fusion
+    void recomputeBlockSummaries();
+    void recomputeBlockSummary(const BlockIndex& block_index);
+
     FloatingPoint block_size_;
     Layer<SSCOccupancyVoxel>::Ptr ssc_layer_;
+    BlockSummaryMap block_summaries_;
+    VoxelLookupFunction voxel_lookup_fn_;
+
+   private:
+    mutable Mutex mutex_;
 };
 }  // namespace voxblox
 #endif //SSC_MAP_H_
\ No newline at end of file
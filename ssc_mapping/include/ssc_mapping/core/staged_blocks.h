@@ -0,0 +1,53 @@
+#ifndef SSC_STAGED_BLOCKS_H_
+#define SSC_STAGED_BLOCKS_H_
+
+#include <voxblox/core/block.h>
+#include <voxblox/core/block_hash.h>
+#include <voxblox/core/common.h>
+
+#include "ssc_mapping/core/block_summary.h"
+#include "ssc_mapping/core/ssc_map.h"
+#include "ssc_mapping/core/voxel.h"
+
+namespace voxblox {
+
+/**
+ * Private copies of the blocks modified by one integration, with their
+ * summaries. The fusion writes into the copies while other threads keep
+ * reading the map, apply() swaps them in. Blocks still held by readers or by
+ * a running snapshot write stay untouched.
+ *
+ * Only to be used by the thread that modifies the map.
+ */
+class SSCStagedBlocks {
+   public:
+    explicit SSCStagedBlocks(SSCMap* map) : map_(CHECK_NOTNULL(map)) {}
+
+    // copy of the block to modify and its summary, copied from the map or
+    // allocated on first access
+    Block<SSCOccupancyVoxel>::Ptr getBlock(const BlockIndex& block_index, SSCBlockSummary** summary);
+
+    // stages a complete new block, e.g. a loaded or received one, its summary is recomputed
+    void insertBlock(const BlockIndex& block_index, const Block<SSCOccupancyVoxel>::Ptr& block);
+
+    bool empty() const { return blocks_.empty(); }
+    size_t size() const { return blocks_.size(); }
+    void getBlockIndices(BlockIndexList* blocks) const;
+
+    // replaces the blocks and summaries of the map with the staged ones, the
+    // caller holds the write lock of the map
+    void apply();
+
+   private:
+    struct StagedBlock {
+        Block<SSCOccupancyVoxel>::Ptr block;
+        SSCBlockSummary summary;
+    };
+
+    SSCMap* map_;
+    AnyIndexHashMapType<StagedBlock>::type blocks_;
+};
+
+}  // namespace voxblox
+
+#endif  // SSC_STAGED_BLOCKS_H_
@@ -1,6 +1,7 @@
 
 #ifndef SSC_VOXEL_H_
 #define SSC_VOXEL_H_
+#include <cstdint>
 #include <string>
 #include <voxblox/core/voxel.h>
 
@@ -13,8 +14,19 @@ struct SSCOccupancyVoxel {
     float label_weight = 0.0f;
 };
 
+// Euclidean distance to the nearest occupied SSC voxel, see SSCEsdfIntegrator
+struct SSCEsdfVoxel {
+    float distance = 0.0f;
+    bool observed = false;
+    bool occupied = false;
+    // whether site_offset points to the nearest occupied voxel, relative to this one
+    bool has_site = false;
+    int8_t site_offset[3] = {0, 0, 0};
+};
+
 namespace voxel_types {
 const std::string kSSCOccupancy = "ssc";
+const std::string kSSCEsdf = "ssc_esdf";
 }  // namespace voxel_types
 
 template <>
@@ -22,5 +34,10 @@ inline std::string getVoxelType<SSCOccupancyVoxel>() {
   return voxel_types::kSSCOccupancy;
 }
 
+template <>
+inline std::string getVoxelType<SSCEsdfVoxel>() {
+  return voxel_types::kSSCEsdf;
+}
+
 }  // namespace voxblox
 #endif //SSC_VOXEL_H_
\ No newline at end of file
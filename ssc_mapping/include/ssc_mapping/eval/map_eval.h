@@ -125,9 +125,12 @@ voxblox::LongIndexSet set_union(const voxblox::LongIndexSet& index_set_a, const
     return union_elements;
 }
 
+// map_obs_occ_correct optionally receives the correctly observed occupied voxels,
+// e.g. to visualize them without intersecting the sets again
 QualityMetrics calculate_quality_metrics(const voxblox::LongIndexSet& gt_occ_all, const voxblox::LongIndexSet& gt_obs_occ,
                                const voxblox::LongIndexSet& gt_free_all, const voxblox::LongIndexSet& gt_obs_free,
-                               const voxblox::LongIndexSet& map_obs_occ, const voxblox::LongIndexSet& map_obs_free) {
+                               const voxblox::LongIndexSet& map_obs_occ, const voxblox::LongIndexSet& map_obs_free,
+                               voxblox::LongIndexSet* map_obs_occ_correct_out = nullptr) {
     // calculate counts
     auto map_obs_occ_correct = set_intersection(map_obs_occ, gt_occ_all);
     auto map_obs_free_correct = set_intersection(map_obs_free, gt_free_all);
@@ -148,6 +151,9 @@ QualityMetrics calculate_quality_metrics(const voxblox::LongIndexSet& gt_occ_all
     metrics.IoU_occ = map_obs_occ_correct / set_union(map_obs_occ, gt_obs_occ);
     metrics.IoU_free = map_obs_free_correct / set_union(map_obs_free, gt_obs_free);
 
+    if (map_obs_occ_correct_out != nullptr) {
+        *map_obs_occ_correct_out = std::move(map_obs_occ_correct);
+    }
     return metrics;
 }
 
@@ -1,6 +1,7 @@
 #ifndef SSC_BASE_FUSION_H_
 #define SSC_BASE_FUSION_H_
 
+#include "ssc_mapping/core/block_summary.h"
 #include "ssc_mapping/core/voxel.h"
 
 namespace ssc_fusion {
@@ -48,6 +49,14 @@ class BaseFusion {
     };
 
     virtual void fuse(voxblox::SSCOccupancyVoxel* voxel, uint predicted_label, float confidence = 0.51f, float weight=0.0f) = 0;
+
+    // fuses a prediction and keeps the summary of the block containing the voxel up to date
+    void fuseWithSummary(voxblox::SSCOccupancyVoxel* voxel, voxblox::SSCBlockSummary* summary, uint predicted_label,
+                         float confidence, float weight) {
+        summary->removeVoxel(*voxel);
+        fuse(voxel, predicted_label, confidence, weight);
+        summary->addVoxel(*voxel);
+    }
 };
 }  // namespace ssc_fusion
 
@@ -0,0 +1,56 @@
+#ifndef SSC_ASYNC_SNAPSHOT_WRITER_H_
+#define SSC_ASYNC_SNAPSHOT_WRITER_H_
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include <voxblox/core/block.h>
+#include <voxblox/core/block_hash.h>
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+
+#include "ssc_mapping/core/voxel.h"
+
+namespace voxblox {
+namespace io {
+
+/**
+ * Writes a consistent snapshot of an SSC layer on a background thread while
+ * the layer keeps being updated. Starting a write only copies the block
+ * pointers into a frozen layer. This needs no copies of the blocks because
+ * they are never mutated in place: SSCStagedBlocks::apply swaps new block
+ * pointers into the live layer, the frozen layer keeps the old ones alive.
+ *
+ * Not thread safe itself, start() and wait() have to be called from the
+ * thread that modifies the layer.
+ */
+class SSCAsyncSnapshotWriter {
+   public:
+    typedef std::function<bool(const Layer<SSCOccupancyVoxel>&, const BlockIndexList&)> WriteFunction;
+
+    SSCAsyncSnapshotWriter() = default;
+    ~SSCAsyncSnapshotWriter();
+
+    SSCAsyncSnapshotWriter(const SSCAsyncSnapshotWriter&) = delete;
+    SSCAsyncSnapshotWriter& operator=(const SSCAsyncSnapshotWriter&) = delete;
+
+    // Freezes the given blocks of the layer and calls write_fn with them on a
+    // background thread. Waits for a previous write to finish first.
+    void start(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks, const WriteFunction& write_fn);
+
+    bool isBusy() const { return result_.valid() && !done_; }
+
+    // Blocks until the running write is done and returns its result, true if there is none.
+    bool wait();
+
+   private:
+    std::atomic<bool> done_{true};
+    std::future<bool> result_;
+};
+
+}  // namespace io
+}  // namespace voxblox
+
+#endif  // SSC_ASYNC_SNAPSHOT_WRITER_H_
@@ -0,0 +1,97 @@
+#ifndef SSC_BLOCK_STORE_H_
+#define SSC_BLOCK_STORE_H_
+
+#include <string>
+
+#include <voxblox/core/block.h>
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+
+#include "ssc_mapping/core/voxel.h"
+
+namespace voxblox {
+namespace io {
+
+/**
+ * Memory mapped persistent storage for SSC blocks. The file is a small header
+ * followed by fixed size block records. Each record holds the block index
+ * (which doubles as the persistent index of the store) and the raw voxel
+ * payload of the block. Blocks written to the store are durable without an
+ * explicit save and other processes can open the same file read only.
+ *
+ * Note: voxels are stored in their in-memory layout, the file is therefore
+ * only portable between hosts with the same endianness and ABI.
+ */
+class SSCBlockStore {
+   public:
+    enum class Mode { kReadOnly, kReadWrite };
+
+    SSCBlockStore() = default;
+    ~SSCBlockStore();
+
+    SSCBlockStore(const SSCBlockStore&) = delete;
+    SSCBlockStore& operator=(const SSCBlockStore&) = delete;
+
+    // Opens an existing store or creates a new one in read write mode. The voxel size
+    // and voxels per side are only used when a new store is created, otherwise they
+    // are checked against the file. Set truncate to discard blocks of an existing store.
+    bool open(const std::string& file_path, Mode mode, FloatingPoint voxel_size = 0.0f,
+              size_t voxels_per_side = 0u, bool truncate = false);
+
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    bool isReadOnly() const { return mode_ == Mode::kReadOnly; }
+
+    FloatingPoint voxel_size() const;
+    size_t voxels_per_side() const;
+    size_t getNumberOfStoredBlocks() const { return slots_.size(); }
+
+    bool hasBlock(const BlockIndex& block_index) const { return slots_.count(block_index) > 0; }
+    void getAllStoredBlocks(BlockIndexList* blocks) const;
+
+    // Copies the voxels of a block into its record, allocating a record if needed.
+    bool writeBlock(const BlockIndex& block_index, const Block<SSCOccupancyVoxel>& block);
+
+    // Copies the voxels of a stored block into the given block.
+    bool readBlock(const BlockIndex& block_index, Block<SSCOccupancyVoxel>* block) const;
+
+    // Writes the given blocks of the layer, e.g. the blocks of a change-set.
+    // Returns the number of written blocks.
+    size_t writeBlocks(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks);
+
+    // Allocates and fills all stored blocks in the layer.
+    bool loadIntoLayer(Layer<SSCOccupancyVoxel>* layer) const;
+
+    // Schedules (async) or forces the write back of dirty pages to disk.
+    bool flush(bool async = true);
+
+   private:
+    struct FileHeader;
+    struct RecordHeader;
+
+    bool mapFile(size_t file_size);
+    void unmapFile();
+    bool reserveRecords(size_t num_records);
+    void rebuildIndex();
+
+    FileHeader* header() const;
+    RecordHeader* record(size_t slot) const;
+    size_t recordSize() const;
+    size_t numVoxels() const;
+
+    std::string file_path_;
+    Mode mode_ = Mode::kReadOnly;
+    int fd_ = -1;
+    char* data_ = nullptr;
+    size_t mapped_size_ = 0u;
+    size_t capacity_ = 0u;
+
+    // in memory lookup from block index to record slot, rebuilt from the records on open
+    AnyIndexHashMapType<size_t>::type slots_;
+};
+
+}  // namespace io
+}  // namespace voxblox
+
+#endif  // SSC_BLOCK_STORE_H_
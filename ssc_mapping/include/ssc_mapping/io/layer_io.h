@@ -0,0 +1,31 @@
+#ifndef SSC_LAYER_IO_H_
+#define SSC_LAYER_IO_H_
+
+#include <string>
+
+#include <voxblox/core/layer.h>
+
+#include "ssc_mapping/core/voxel.h"
+
+namespace voxblox {
+namespace io {
+
+// file extension of memory mapped block stores
+const std::string kBlockStoreExtension = ".sscm";
+
+bool hasExtension(const std::string& file_path, const std::string& extension);
+
+// Loads an SSC layer from any of the supported formats. The format is picked
+// from the file extension, voxblox protobuf layers are the default.
+bool LoadSSCLayer(const std::string& file_path, Layer<SSCOccupancyVoxel>::Ptr* layer_ptr, size_t num_threads = 0u);
+
+// Loads a voxblox protobuf layer. The file is memory mapped and the message
+// framing is scanned up front, the block messages are then decoded on
+// num_threads threads (0 uses all hardware threads).
+bool LoadSSCLayerParallel(const std::string& file_path, Layer<SSCOccupancyVoxel>::Ptr* layer_ptr,
+                          size_t num_threads = 0u);
+
+}  // namespace io
+}  // namespace voxblox
+
+#endif  // SSC_LAYER_IO_H_
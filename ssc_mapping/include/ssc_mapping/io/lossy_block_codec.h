@@ -0,0 +1,43 @@
+#ifndef SSC_LOSSY_BLOCK_CODEC_H_
+#define SSC_LOSSY_BLOCK_CODEC_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <voxblox/core/block.h>
+
+#include "ssc_mapping/core/voxel.h"
+
+namespace voxblox {
+namespace io {
+
+/**
+ * Lossy block encoding for streaming the map over low bandwidth links.
+ * Only observed voxels are kept. Voxels whose log odds exceed the confident
+ * log odds only keep their label and whether they are occupied, all other
+ * voxels additionally keep their log odds quantized to an int8 multiple of
+ * the log odds step. Label weights are dropped. The packed planes are
+ * entropy coded with deflate:
+ *
+ *   flags | log odds step | confident log odds | observed bitmap |
+ *   confident bitmap | occupied bitmap of confident voxels | labels | quantized log odds
+ *
+ * Decoded voxels are meant for display and supervision, not for fusing further.
+ */
+struct LossyBlockCodecConfig {
+    float log_odds_step = 0.05f;
+    float confident_log_odds = 2.0f;
+    int compression_level = 9;
+};
+
+bool encodeSSCBlockLossy(const Block<SSCOccupancyVoxel>& block, const LossyBlockCodecConfig& config,
+                         std::vector<uint8_t>* compressed, uint32_t* raw_size);
+
+// Inverse of encodeSSCBlockLossy, the quantization parameters are read from the payload.
+bool decodeSSCBlockLossy(const uint8_t* compressed, size_t compressed_size, size_t raw_size,
+                         Block<SSCOccupancyVoxel>* block);
+
+}  // namespace io
+}  // namespace voxblox
+
+#endif  // SSC_LOSSY_BLOCK_CODEC_H_
@@ -0,0 +1,106 @@
+#ifndef SSC_SNAPSHOT_H_
+#define SSC_SNAPSHOT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <voxblox/core/block.h>
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+
+#include "ssc_mapping/core/voxel.h"
+
+namespace voxblox {
+namespace io {
+
+// file extension of compressed snapshots
+const std::string kSnapshotExtension = ".sscz";
+
+/**
+ * Compressed snapshot of an SSC layer. Every block is bit-packed and
+ * compressed on its own, so blocks can be encoded and decoded in parallel
+ * and read individually:
+ *
+ *   header | compressed block 0 | ... | compressed block n-1 | block index
+ *
+ * The block index holds the block indices with the file offsets and sizes of
+ * their payloads. Packed blocks store a bitmap of the voxels that differ from
+ * a default voxel, a bitmap of the observed flags of these voxels, followed
+ * by their labels, log probabilities and label weights as separate planes.
+ *
+ * Delta snapshots only hold the blocks modified since the previous snapshot
+ * and are meant to be applied on top of it, see snapshot_manifest.h.
+ */
+class SSCSnapshotReader {
+   public:
+    struct IndexEntry {
+        BlockIndex block_index;
+        uint64_t offset;
+        uint32_t compressed_size;
+        uint32_t raw_size;
+    };
+
+    SSCSnapshotReader() = default;
+    ~SSCSnapshotReader();
+
+    SSCSnapshotReader(const SSCSnapshotReader&) = delete;
+    SSCSnapshotReader& operator=(const SSCSnapshotReader&) = delete;
+
+    // reads the header and the block index
+    bool open(const std::string& file_path);
+    void close();
+
+    bool isOpen() const { return fd_ >= 0; }
+    FloatingPoint voxel_size() const { return voxel_size_; }
+    size_t voxels_per_side() const { return voxels_per_side_; }
+    size_t getNumberOfBlocks() const { return entries_.size(); }
+    bool isDelta() const { return is_delta_; }
+
+    bool hasBlock(const BlockIndex& block_index) const { return entry_lookup_.count(block_index) > 0; }
+    void getAllBlocks(BlockIndexList* blocks) const;
+
+    // Decodes a single block, thread safe.
+    bool readBlock(const BlockIndex& block_index, Block<SSCOccupancyVoxel>* block) const;
+
+    // Decodes all blocks on num_threads threads (0 uses all hardware threads) and
+    // inserts them into the layer, replacing blocks with the same index.
+    bool loadIntoLayer(Layer<SSCOccupancyVoxel>* layer, size_t num_threads = 0u) const;
+
+   private:
+    bool readEntry(const IndexEntry& entry, Block<SSCOccupancyVoxel>* block) const;
+
+    std::string file_path_;
+    int fd_ = -1;
+    FloatingPoint voxel_size_ = 0.0f;
+    size_t voxels_per_side_ = 0u;
+    bool is_delta_ = false;
+    std::vector<IndexEntry> entries_;
+    AnyIndexHashMapType<size_t>::type entry_lookup_;
+};
+
+// Packs and compresses the voxels of a block. Returns false if compression failed.
+bool encodeSSCBlock(const Block<SSCOccupancyVoxel>& block, std::vector<uint8_t>* compressed, uint32_t* raw_size);
+
+// Inverse of encodeSSCBlock, the block has to have the same number of voxels.
+bool decodeSSCBlock(const uint8_t* compressed, size_t compressed_size, size_t raw_size,
+                    Block<SSCOccupancyVoxel>* block);
+
+// Writes a snapshot of all blocks of the layer, encoding on num_threads
+// threads (0 uses all hardware threads). The file is written next to the
+// target and renamed when complete.
+bool SaveSSCSnapshot(const Layer<SSCOccupancyVoxel>& layer, const std::string& file_path, size_t num_threads = 0u);
+
+// Same, but only for the given blocks. Set is_delta if the snapshot only
+// holds the changes on top of an earlier snapshot.
+bool SaveSSCSnapshot(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks,
+                     const std::string& file_path, size_t num_threads = 0u, bool is_delta = false);
+
+// Loads a snapshot into a new layer. Delta snapshots are reconstructed from
+// the manifest next to them.
+bool LoadSSCSnapshot(const std::string& file_path, Layer<SSCOccupancyVoxel>::Ptr* layer_ptr, size_t num_threads = 0u);
+
+}  // namespace io
+}  // namespace voxblox
+
+#endif  // SSC_SNAPSHOT_H_
@@ -0,0 +1,57 @@
+#ifndef SSC_SNAPSHOT_MANIFEST_H_
+#define SSC_SNAPSHOT_MANIFEST_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <voxblox/core/layer.h>
+
+#include "ssc_mapping/core/voxel.h"
+
+namespace voxblox {
+namespace io {
+
+// name of the manifest file kept next to the snapshots it lists
+const std::string kSnapshotManifestName = "snapshots.manifest";
+
+/**
+ * Sequence of periodic snapshots of a map. Every step is either a full (base)
+ * snapshot or a delta snapshot holding only the blocks modified since the
+ * previous step. The manifest is a text file with one step per line:
+ *
+ *   base|delta <snapshot file name> <map version>
+ *
+ * Snapshot file names are relative to the directory of the manifest.
+ */
+struct SnapshotManifestEntry {
+    bool is_delta = false;
+    std::string file_name;
+    uint64_t map_version = 0u;
+};
+
+// manifest belonging to a snapshot, i.e. kSnapshotManifestName in the same directory
+std::string getSnapshotManifestPath(const std::string& snapshot_path);
+
+// directory of the file including the trailing separator, empty for relative file names
+std::string getDirectory(const std::string& file_path);
+
+std::string getFileName(const std::string& file_path);
+
+bool LoadSnapshotManifest(const std::string& manifest_path, std::vector<SnapshotManifestEntry>* entries);
+
+bool AppendSnapshotManifestEntry(const std::string& manifest_path, const SnapshotManifestEntry& entry);
+
+// Rebuilds the map at the given step of the manifest from the latest base
+// snapshot at or before the step and all deltas after it.
+bool ReconstructSSCLayer(const std::string& manifest_path, size_t step, Layer<SSCOccupancyVoxel>::Ptr* layer_ptr,
+                         size_t num_threads = 0u);
+
+// Same, for the step that wrote the given snapshot.
+bool ReconstructSSCLayerFromSnapshot(const std::string& snapshot_path, Layer<SSCOccupancyVoxel>::Ptr* layer_ptr,
+                                     size_t num_threads = 0u);
+
+}  // namespace io
+}  // namespace voxblox
+
+#endif  // SSC_SNAPSHOT_MANIFEST_H_
@@ -0,0 +1,28 @@
+#ifndef SSC_LAYER_CONVERSIONS_H_
+#define SSC_LAYER_CONVERSIONS_H_
+
+#include <ssc_msgs/SSCLayer.h>
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+
+#include "ssc_mapping/core/voxel.h"
+#include "ssc_mapping/io/lossy_block_codec.h"
+
+namespace voxblox {
+
+// Serializes the given blocks of the layer into the message, the blocks are
+// compressed on num_threads threads (0 uses all hardware threads). Blocks
+// that are not allocated are skipped. The versions and action are left to the caller.
+// Blocks are encoded lossy with the given config if there is one.
+bool serializeSSCBlocksAsMsg(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks,
+                             ssc_msgs::SSCLayer* msg, size_t num_threads = 0u,
+                             const io::LossyBlockCodecConfig* lossy_config = nullptr);
+
+// Applies an update to the layer, clearing it first for RESET updates.
+// Lists the replaced blocks in updated_blocks if given.
+bool deserializeMsgToSSCLayer(const ssc_msgs::SSCLayer& msg, Layer<SSCOccupancyVoxel>* layer,
+                              BlockIndexList* updated_blocks = nullptr, size_t num_threads = 0u);
+
+}  // namespace voxblox
+
+#endif  // SSC_LAYER_CONVERSIONS_H_
@@ -0,0 +1,83 @@
+#ifndef SSC_LAYER_CLIENT_H_
+#define SSC_LAYER_CLIENT_H_
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <ros/ros.h>
+#include <ssc_msgs/SSCLayer.h>
+
+#include "ssc_mapping/core/change_tracker.h"
+#include "ssc_mapping/core/ssc_map.h"
+
+namespace voxblox {
+
+/**
+ * Mirrors the SSC map of a remote SSCServer from its incremental layer
+ * updates or its lossy map stream without running the fusion. Missed updates are detected from the
+ * map versions and trigger a full resync through the resync service of the
+ * server. The resync is requested once, updates are dropped until its RESET
+ * arrives and it is only requested again after resync_timeout seconds.
+ *
+ * The service is called on a background thread so the subscriber callback
+ * never blocks on the server.
+ */
+class SSCLayerClient {
+   public:
+    // layer_topic is the ssc_layer_updates or ssc_map_stream topic of the server, the resync service
+    // defaults to resync_layer in the same namespace
+    SSCLayerClient(const ros::NodeHandle& nh, const SSCMap::Config& config, const std::string& layer_topic,
+                   const std::string& resync_service = std::string(), double resync_timeout = 2.0);
+    ~SSCLayerClient();
+
+    inline std::shared_ptr<SSCMap> getSSCMapPtr() { return ssc_map_; }
+    inline std::shared_ptr<const SSCMap> getSSCMapPtr() const { return ssc_map_; }
+
+    // map version of the server the mirrored map corresponds to
+    uint64_t getMapVersion() const { return server_map_version_; }
+
+    // local change-sets of the applied updates
+    inline SSCChangeTracker& getChangeTracker() { return change_tracker_; }
+    SSCChangeTracker::ListenerId addChangeListener(const SSCChangeTracker::Listener& listener) {
+        return change_tracker_.addListener(listener);
+    }
+
+    // asks the server to publish all blocks, returns false if the service call failed. Blocks
+    // until the server answered, the client itself only calls it through scheduleResync().
+    bool requestResync();
+
+    void layerUpdateCallback(const ssc_msgs::SSCLayer::ConstPtr& msg);
+
+   private:
+    // starts a resync request in the background unless one is running or was
+    // sent less than resync_timeout ago
+    void scheduleResync();
+    void resyncTimerCallback(const ros::WallTimerEvent& event);
+
+    std::shared_ptr<SSCMap> ssc_map_;
+    SSCChangeTracker change_tracker_;
+    uint64_t server_map_version_ = 0u;
+
+    // updates are dropped until the requested full layer arrives
+    std::atomic<bool> awaiting_resync_{true};
+
+    // running resync request and when it was sent, guarded by resync_mutex_
+    std::mutex resync_mutex_;
+    std::future<bool> resync_call_;
+    ros::WallTime last_resync_request_;
+    bool resync_requested_ = false;
+    ros::WallDuration resync_timeout_;
+
+    ros::NodeHandle nh_;
+    ros::Subscriber layer_update_sub_;
+    ros::ServiceClient resync_client_;
+    // re-requests a resync whose RESET did not arrive in time
+    ros::WallTimer resync_timer_;
+};
+
+}  // namespace voxblox
+
+#endif  // SSC_LAYER_CLIENT_H_
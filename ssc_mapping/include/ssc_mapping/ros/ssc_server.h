@@ -1,13 +1,28 @@
 #ifndef SSC_SERVER_VOXBLOX_H_
 #define SSC_SERVER_VOXBLOX_H_
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+
 #include <ros/ros.h>
 #include <ssc_msgs/SSCGrid.h>
+#include <std_srvs/Empty.h>
 #include <voxblox/core/layer.h>
 #include <voxblox/io/layer_io.h>
+#include <voxblox/mesh/mesh_layer.h>
+#include <voxblox_msgs/Mesh.h>
 #include <voxblox_msgs/FilePath.h>
+#include "ssc_mapping/core/change_tracker.h"
 #include "ssc_mapping/core/ssc_map.h"
+#include "ssc_mapping/core/staged_blocks.h"
 #include "ssc_mapping/fusion/base_fusion.h"
+#include "ssc_mapping/io/async_snapshot_writer.h"
+#include "ssc_mapping/io/block_store.h"
+#include "ssc_mapping/io/lossy_block_codec.h"
+#include "ssc_mapping/visualization/lod_pyramid.h"
+#include "ssc_mapping/visualization/ssc_mesh_integrator.h"
+#include "ssc_mapping/visualization/visualization_cache.h"
 
 namespace voxblox {
 
@@ -18,6 +33,9 @@ class SSCServer {
 
     SSCServer(const ros::NodeHandle& nh, const ros::NodeHandle& nh_private, const ssc_fusion::BaseFusion::Config&, const SSCMap::Config&);
 
+    // waits for a map save still running in the background
+    virtual ~SSCServer() { snapshot_writer_.wait(); }
+
     static ssc_fusion::BaseFusion::Config getFusionConfigROSParam(const ros::NodeHandle& nh, const ros::NodeHandle& nh_private);
 
     static SSCMap::Config getSSCMapConfigFromRosParam(const ros::NodeHandle& nh_private);
@@ -28,33 +46,176 @@ class SSCServer {
 
     std::string getWorldFrame() const { return world_frame_; }
 
-    virtual void clear() { ssc_map_->getSSCLayerPtr()->removeAllBlocks(); }
+    virtual void clear();
 
     inline std::shared_ptr<SSCMap> getSSCMapPtr() { return ssc_map_; }
     inline std::shared_ptr<const SSCMap> getSSCMapPtr() const { return ssc_map_; }
 
+    // change-sets of the integrations, map/block versions and in-process listeners
+    inline SSCChangeTracker& getChangeTracker() { return change_tracker_; }
+    inline const SSCChangeTracker& getChangeTracker() const { return change_tracker_; }
+    inline uint64_t getMapVersion() const { return change_tracker_.getMapVersion(); }
+    SSCChangeTracker::ListenerId addChangeListener(const SSCChangeTracker::Listener& listener) {
+        return change_tracker_.addListener(listener);
+    }
+
+    // publish the occupied voxels, assembled from the per-block visualization cache
     void publishSSCOccupancyPoints();
 
     void publishSSCOccupiedNodes();
 
+    // publishes the occupied voxels at the level of detail selected per region
+    void publishSSCOccupiedNodesLod();
+
+    // publishes the pointcloud, markers and mesh if anyone subscribed to them
+    void publishVisualization();
+
+    // remeshes the blocks changed since the last call and publishes the updated meshes
+    void publishMesh();
+    void publishVisualizationEvent(const ros::TimerEvent& event) {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        publishVisualization();
+    }
+
+    // saves the map as .ssc protobuf or .sscz snapshot. With delta_snapshots enabled,
+    // .sscz snapshots after the first one of a directory only hold the blocks modified
+    // since the previous one, see io/snapshot_manifest.h. With async_save_map the file
+    // is written in the background and, unless save_map_blocking is set, true only
+    // means the write was started.
     virtual bool saveMap(const std::string& file_path);
 
+    // blocks until a map save running in the background is written, returns its result
+    bool waitForSaveMap() { return snapshot_writer_.wait(); }
+
     bool saveMapCallback(voxblox_msgs::FilePath::Request& request,     // NOLINT
                        voxblox_msgs::FilePath::Response& response); 
 
+    // merges a saved layer (.ssc protobuf, .sscz snapshot or .sscm block store) into the map,
+    // blocks present in both are replaced by the loaded ones
+    virtual bool loadMap(const std::string& file_path);
+
+    bool loadMapCallback(voxblox_msgs::FilePath::Request& request,     // NOLINT
+                         voxblox_msgs::FilePath::Response& response);
+
+    // publishes the blocks changed since the last update on ssc_layer_updates
+    void publishLayerUpdate();
+    void publishLayerUpdateEvent(const ros::TimerEvent& event) {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        publishLayerUpdate();
+    }
+
+    // publishes all blocks as a RESET update, e.g. for a client that missed updates
+    void publishFullLayer();
+
+    // publishes the next lossy encoded blocks of the map stream on ssc_map_stream,
+    // blocks closest to the vehicle first, within the bandwidth budget
+    void publishMapStream();
+    void publishMapStreamEvent(const ros::TimerEvent& event) {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        publishMapStream();
+    }
+    bool resyncLayerCallback(std_srvs::Empty::Request& request,     // NOLINT
+                             std_srvs::Empty::Response& response);  // NOLINT
+
    private:
+    // rebuilds the cached geometry of the blocks changed since the last update
+    void updateVisualizationCache();
+
+    // fuses the grid into staged copies of the blocks, IndexMath is one of the block size specializations
+    template <typename IndexMath>
+    void integrateGrid(const ssc_msgs::SSCGrid& msg, const IndexMath& math, SSCStagedBlocks* staged_blocks);
+
     bool publish_pointclouds_on_update_;
+    double visualization_period_ = 1.0;
+    bool per_block_markers_ = false;
+    size_t marker_subscribers_ = 0u;
     float decay_weight_std_;
     std::string world_frame_;
     std::string ssc_topic_;
     std::shared_ptr<SSCMap> ssc_map_;
     std::shared_ptr<ssc_fusion::BaseFusion> base_fusion_;
+    std::function<void(const ssc_msgs::SSCGrid&, SSCStagedBlocks*)> integrate_grid_fn_;
+
+    // serializes the subscriber, timer and service callbacks of the server, so it
+    // can share a multi-threaded spinner. Readers of the map use its read lock.
+    std::mutex callback_mutex_;
+
+    SSCChangeTracker change_tracker_;
+
+    // number of threads encoding/decoding saved and loaded maps, 0 uses all hardware threads
+    int io_threads_ = 0;
+
+    // delta snapshot state: map version of the last snapshot and its manifest,
+    // a new base snapshot is written after a clear or in a new directory
+    bool delta_snapshots_ = false;
+    std::atomic<bool> snapshot_base_pending_{true};
+    uint64_t last_snapshot_version_ = 0u;
+    std::string snapshot_manifest_path_;
+
+    // writes saved maps in the background from a snapshot of the block pointers
+    bool async_save_map_ = true;
+    bool save_map_blocking_ = false;
+    io::SSCAsyncSnapshotWriter snapshot_writer_;
+
+    // incremental layer updates for clients mirroring the map, blocks changed since
+    // the last published update and the map version it brought the clients to
+    bool publish_layer_updates_ = false;
+    double layer_update_period_ = 1.0;
+    IndexSet layer_update_blocks_;
+    bool layer_update_reset_ = false;
+    uint64_t published_map_version_ = 0u;
+
+    // lossy map stream for low bandwidth links, blocks not yet streamed and the center
+    // of the last integrated grid as the vehicle position
+    bool stream_map_ = false;
+    double stream_period_ = 0.5;
+    double stream_max_bytes_per_second_ = 0.0;
+    bool stream_nearest_first_ = true;
+    io::LossyBlockCodecConfig stream_codec_config_;
+    IndexSet stream_blocks_;
+    bool stream_reset_ = true;
+    uint64_t streamed_map_version_ = 0u;
+    Point last_grid_center_ = Point::Zero();
+
+    // occupied voxel geometry per block and the blocks changed since it was updated
+    SSCVisualizationCache visualization_cache_;
+    IndexSet visualization_blocks_;
+    bool visualization_reset_ = false;
+    bool pointcloud_outdated_ = true;
+    bool occupied_nodes_outdated_ = true;
+
+    // coarser levels of the occupied voxels for overviews, updated together with the
+    // cache, and the vehicle position they were last published for
+    std::unique_ptr<SSCLodPyramid> lod_pyramid_;
+    bool lod_outdated_ = true;
+    Point lod_center_ = Point::Zero();
+
+    // surface mesh of the occupied voxels, remeshed for the changed blocks
+    bool publish_mesh_ = false;
+    MeshLayer::Ptr mesh_layer_;
+    std::unique_ptr<SSCMeshIntegrator> mesh_integrator_;
+    IndexSet mesh_blocks_;
+    bool mesh_reset_ = false;
+    size_t mesh_subscribers_ = 0u;
+
+    // optional memory mapped store that persists every integrated block
+    std::string block_store_path_;
+    std::unique_ptr<io::SSCBlockStore> block_store_;
 
     //services/publishers/subscribers
     ros::ServiceServer save_map_srv_;
+    ros::ServiceServer load_map_srv_;
+    ros::ServiceServer resync_layer_srv_;
+    ros::Publisher layer_update_pub_;
+    ros::Timer layer_update_timer_;
+    ros::Publisher map_stream_pub_;
+    ros::Timer map_stream_timer_;
     ros::Subscriber ssc_map_sub_;
     ros::Publisher ssc_pointcloud_pub_;
     ros::Publisher occupancy_marker_pub_;
+    ros::Publisher lod_marker_pub_;
+    ros::Timer visualization_timer_;
+    ros::Publisher mesh_pub_;
     ros::NodeHandle nh_;
     ros::NodeHandle nh_private_;
     //tf::TransformListener tf_listener_;
@@ -0,0 +1,150 @@
+#ifndef SSC_BLOCK_INDEX_MATH_H_
+#define SSC_BLOCK_INDEX_MATH_H_
+
+#include <cstddef>
+
+#include <glog/logging.h>
+#include <voxblox/core/common.h>
+
+namespace voxblox {
+
+constexpr int log2OfPowerOfTwo(size_t value) { return value <= 1u ? 0 : 1 + log2OfPowerOfTwo(value / 2u); }
+
+// Index conversions for a fixed, power of two number of voxels per block
+// side. Block and local voxel indices reduce to arithmetic shifts and masks
+// instead of the divides and modulos of the generic voxblox helpers.
+// Shifts of negative indices rely on arithmetic right shift, which all
+// supported compilers implement.
+template <size_t kVoxelsPerSide>
+struct BlockIndexMath {
+    static_assert(kVoxelsPerSide > 0u && (kVoxelsPerSide & (kVoxelsPerSide - 1u)) == 0u,
+                  "voxels per side has to be a power of two");
+
+    static constexpr int kShift = log2OfPowerOfTwo(kVoxelsPerSide);
+    static constexpr LongIndexElement kMask = static_cast<LongIndexElement>(kVoxelsPerSide) - 1;
+    static constexpr size_t kNumVoxels = kVoxelsPerSide * kVoxelsPerSide * kVoxelsPerSide;
+
+    explicit BlockIndexMath(size_t voxels_per_side = kVoxelsPerSide) {
+        DCHECK_EQ(voxels_per_side, kVoxelsPerSide);
+    }
+
+    size_t voxels_per_side() const { return kVoxelsPerSide; }
+    size_t num_voxels() const { return kNumVoxels; }
+
+    BlockIndex computeBlockIndex(const GlobalIndex& global_index) const {
+        return BlockIndex(static_cast<IndexElement>(global_index.x() >> kShift),
+                          static_cast<IndexElement>(global_index.y() >> kShift),
+                          static_cast<IndexElement>(global_index.z() >> kShift));
+    }
+
+    VoxelIndex computeVoxelIndex(const GlobalIndex& global_index) const {
+        return VoxelIndex(static_cast<IndexElement>(global_index.x() & kMask),
+                          static_cast<IndexElement>(global_index.y() & kMask),
+                          static_cast<IndexElement>(global_index.z() & kMask));
+    }
+
+    void computeBlockAndVoxelIndex(const GlobalIndex& global_index, BlockIndex* block_index,
+                                   VoxelIndex* voxel_index) const {
+        *block_index = computeBlockIndex(global_index);
+        *voxel_index = computeVoxelIndex(global_index);
+    }
+
+    // same layout as Block::computeLinearIndexFromVoxelIndex, x is the fastest axis
+    size_t computeLinearIndex(const VoxelIndex& voxel_index) const {
+        return static_cast<size_t>(voxel_index.x()) | static_cast<size_t>(voxel_index.y()) << kShift |
+               static_cast<size_t>(voxel_index.z()) << (2 * kShift);
+    }
+
+    size_t computeLinearIndex(const GlobalIndex& global_index) const {
+        return static_cast<size_t>(global_index.x() & kMask) |
+               static_cast<size_t>(global_index.y() & kMask) << kShift |
+               static_cast<size_t>(global_index.z() & kMask) << (2 * kShift);
+    }
+
+    VoxelIndex computeVoxelIndexFromLinearIndex(size_t linear_index) const {
+        return VoxelIndex(static_cast<IndexElement>(linear_index & kMask),
+                          static_cast<IndexElement>((linear_index >> kShift) & kMask),
+                          static_cast<IndexElement>(linear_index >> (2 * kShift)));
+    }
+
+    GlobalIndex computeGlobalIndex(const BlockIndex& block_index, const VoxelIndex& voxel_index) const {
+        return GlobalIndex(static_cast<LongIndexElement>(block_index.x()) << kShift | voxel_index.x(),
+                           static_cast<LongIndexElement>(block_index.y()) << kShift | voxel_index.y(),
+                           static_cast<LongIndexElement>(block_index.z()) << kShift | voxel_index.z());
+    }
+
+    GlobalIndex computeGlobalIndex(const BlockIndex& block_index, size_t linear_index) const {
+        return computeGlobalIndex(block_index, computeVoxelIndexFromLinearIndex(linear_index));
+    }
+};
+
+// Fallback for block sizes without a specialization, same interface
+// on top of the generic voxblox helpers.
+struct RuntimeBlockIndexMath {
+    explicit RuntimeBlockIndexMath(size_t voxels_per_side)
+        : voxels_per_side_(voxels_per_side), num_voxels_(voxels_per_side * voxels_per_side * voxels_per_side) {}
+
+    size_t voxels_per_side() const { return voxels_per_side_; }
+    size_t num_voxels() const { return num_voxels_; }
+
+    BlockIndex computeBlockIndex(const GlobalIndex& global_index) const {
+        return getBlockIndexFromGlobalVoxelIndex(global_index, 1.0 / voxels_per_side_);
+    }
+
+    VoxelIndex computeVoxelIndex(const GlobalIndex& global_index) const {
+        return getLocalFromGlobalVoxelIndex(global_index, voxels_per_side_);
+    }
+
+    void computeBlockAndVoxelIndex(const GlobalIndex& global_index, BlockIndex* block_index,
+                                   VoxelIndex* voxel_index) const {
+        getBlockAndVoxelIndexFromGlobalVoxelIndex(global_index, voxels_per_side_, block_index, voxel_index);
+    }
+
+    size_t computeLinearIndex(const VoxelIndex& voxel_index) const {
+        return voxel_index.x() + voxels_per_side_ * (voxel_index.y() + voxel_index.z() * voxels_per_side_);
+    }
+
+    size_t computeLinearIndex(const GlobalIndex& global_index) const {
+        return computeLinearIndex(computeVoxelIndex(global_index));
+    }
+
+    VoxelIndex computeVoxelIndexFromLinearIndex(size_t linear_index) const {
+        const size_t rest = linear_index / voxels_per_side_;
+        return VoxelIndex(static_cast<IndexElement>(linear_index % voxels_per_side_),
+                          static_cast<IndexElement>(rest % voxels_per_side_),
+                          static_cast<IndexElement>(rest / voxels_per_side_));
+    }
+
+    GlobalIndex computeGlobalIndex(const BlockIndex& block_index, const VoxelIndex& voxel_index) const {
+        return getGlobalVoxelIndexFromBlockAndVoxelIndex(block_index, voxel_index, voxels_per_side_);
+    }
+
+    GlobalIndex computeGlobalIndex(const BlockIndex& block_index, size_t linear_index) const {
+        return computeGlobalIndex(block_index, computeVoxelIndexFromLinearIndex(linear_index));
+    }
+
+    size_t voxels_per_side_;
+    size_t num_voxels_;
+};
+
+// Calls visitor(math) with the BlockIndexMath specialized for the given block
+// size, or with RuntimeBlockIndexMath if there is none. Meant to be called
+// once at startup, e.g. to pick an instantiation of a templated loop.
+template <typename Visitor>
+auto dispatchBlockIndexMath(size_t voxels_per_side, Visitor&& visitor)
+    -> decltype(visitor(RuntimeBlockIndexMath(voxels_per_side))) {
+    switch (voxels_per_side) {
+        case 8u:
+            return visitor(BlockIndexMath<8u>(voxels_per_side));
+        case 16u:
+            return visitor(BlockIndexMath<16u>(voxels_per_side));
+        case 32u:
+            return visitor(BlockIndexMath<32u>(voxels_per_side));
+        default:
+            return visitor(RuntimeBlockIndexMath(voxels_per_side));
+    }
+}
+
+}  // namespace voxblox
+
+#endif  // SSC_BLOCK_INDEX_MATH_H_
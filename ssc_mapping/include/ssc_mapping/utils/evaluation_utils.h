@@ -16,6 +16,8 @@
 
 
 #include <ssc_mapping/visualization/visualization.h>
+#include <ssc_mapping/utils/block_index_math.h>
+#include <ssc_mapping/utils/morton.h>
 #include <ssc_mapping/utils/voxel_utils.h>
 
 
@@ -25,16 +27,33 @@ voxblox::GlobalIndex get_voxel_index_from_point(
   return voxblox::getGridIndexFromPoint<voxblox::GlobalIndex>(point, voxel_size_inv);
 }
 
+// Remembers the last looked up block, neighbouring voxel lookups mostly
+// land in the same block and can skip the hash map.
+struct BlockLookupCache {
+  bool valid = false;
+  voxblox::BlockIndex block_idx;
+  voxblox::Block<voxblox::TsdfVoxel>::ConstPtr block;
+};
+
 // returns the state of a voxel, wheter occupied, free or unknown
+template <typename IndexMath>
 int get_voxel_state(
-    const voxblox::GlobalIndex& index, const voxblox::Layer<voxblox::TsdfVoxel>& layer) {
-  voxblox::BlockIndex block_idx;
-  voxblox::VoxelIndex voxel_idx;
-  voxblox::getBlockAndVoxelIndexFromGlobalVoxelIndex(
-      index, layer.voxels_per_side(), &block_idx, &voxel_idx);
-  const auto block = layer.getBlockPtrByIndex(block_idx);
+    const voxblox::GlobalIndex& index, const voxblox::Layer<voxblox::TsdfVoxel>& layer,
+    const IndexMath& math, BlockLookupCache* cache = nullptr) {
+  const voxblox::BlockIndex block_idx = math.computeBlockIndex(index);
+  voxblox::Block<voxblox::TsdfVoxel>::ConstPtr block;
+  if (cache != nullptr && cache->valid && cache->block_idx == block_idx) {
+    block = cache->block;
+  } else {
+    block = layer.getBlockPtrByIndex(block_idx);
+    if (cache != nullptr) {
+      cache->valid = true;
+      cache->block_idx = block_idx;
+      cache->block = block;
+    }
+  }
   if (block) {
-    const voxblox::TsdfVoxel& voxel = block->getVoxelByVoxelIndex(voxel_idx);
+    const voxblox::TsdfVoxel& voxel = block->getVoxelByLinearIndex(math.computeLinearIndex(index));
     if (voxel.weight > 1e-6) {
       if (voxel.distance > layer.voxel_size()/2) {
         return 0;
@@ -46,6 +65,11 @@ int get_voxel_state(
   return 2;
 }
 
+int get_voxel_state(
+    const voxblox::GlobalIndex& index, const voxblox::Layer<voxblox::TsdfVoxel>& layer) {
+  return get_voxel_state(index, layer, voxblox::RuntimeBlockIndexMath(layer.voxels_per_side()));
+}
+
 // start free space explroation from start point and 
 // mark all reachable free voxels. 
 // Returns a list of global indices of free voxels, and 
@@ -75,41 +99,44 @@ void compute_free_occupied_space_frontier(
   // Setup search.
   voxblox::LongIndexSet closed_list;
   std::stack<GlobalIndex> open_stack;
+  BlockLookupCache block_cache;
   
   open_stack.push(get_voxel_index_from_point(initial_point, voxel_size_inv));
 
   // Search all frontiers.
-  while (!open_stack.empty()) {
-    // 'current', including the initial point, traverse observed free space.
-    auto current = open_stack.top();
-    open_stack.pop();
+  voxblox::dispatchBlockIndexMath(layer.voxels_per_side(), [&](const auto& math) {
+    while (!open_stack.empty()) {
+      // 'current', including the initial point, traverse observed free space.
+      auto current = open_stack.top();
+      open_stack.pop();
     
 
-    // Check all neighbors for frontiers and free space.
-    for (auto offset : kNeighborOffsets) {
-      auto candidate = current + offset;
-       if (closed_list.find(candidate) != closed_list.end()) {
-        // Only consider voxels that were not yet checked.
-        continue;
-      }
-      switch (get_voxel_state(candidate, layer)) {
-        case 0: //free
-        case 2: {//unknown
-          // Adjacent free space to continue the search.
-          open_stack.push(candidate);
-          closed_list.insert(candidate);
+      // Check all neighbors for frontiers and free space.
+      for (auto offset : kNeighborOffsets) {
+        auto candidate = current + offset;
+         if (closed_list.find(candidate) != closed_list.end()) {
+          // Only consider voxels that were not yet checked.
+          continue;
+        }
+        switch (get_voxel_state(candidate, layer, math, &block_cache)) {
+          case 0: //free
+          case 2: {//unknown
+            // Adjacent free space to continue the search.
+            open_stack.push(candidate);
+            closed_list.insert(candidate);
           
-          break;
+            break;
+          }
+          case 1:
+          default:
+            // We hit an obstacle.
+            obstacles->emplace_back(candidate);
+            break;
         }
-        case 1:
-        default:
-          // We hit an obstacle.
-          obstacles->emplace_back(candidate);
-          break;
       }
     }
-  }
-  
+  });
+
   auto t_end = std::chrono::high_resolution_clock::now();
   std::copy(closed_list.begin(), closed_list.end(),  std::back_inserter(*voxels));
 
@@ -129,24 +156,21 @@ void refine_observed_layer(const voxblox::Layer<VoxelTypeA>& gt_layer,
     size_t num_voxels_per_block = vps * vps * vps;
 
     voxblox::BlockIndexList blocks;
-    observed_layer->getAllAllocatedBlocks(&blocks);
+    voxblox::morton::getAllAllocatedBlocks(*observed_layer, &blocks);
     for (const voxblox::BlockIndex& block_idx : blocks) {
         auto block = observed_layer->getBlockPtrByIndex(block_idx);
+        // both layers share the block size, so the voxel at the same linear
+        // index of the same block in the ground truth layer is the one to check
+        auto gt_block = gt_layer.getBlockPtrByIndex(block_idx);
 
         for (size_t linear_index = 0; linear_index < num_voxels_per_block; ++linear_index) {
             // voxblox::Point coord = block.computeCoordinatesFromLinearIndex(linear_index);
             auto voxel = &block->getVoxelByLinearIndex(linear_index);
-            voxblox::VoxelIndex voxel_idx = block->computeVoxelIndexFromLinearIndex(linear_index);
-                voxblox::GlobalIndex global_voxel_idx =
-                    voxblox::getGlobalVoxelIndexFromBlockAndVoxelIndex(block_idx, voxel_idx, gt_layer.voxels_per_side());
-
-                // see if this voxel is observed in other layer
-                auto gt_voxel = gt_layer.getVoxelPtrByGlobalIndex(global_voxel_idx);
 
-                if(!gt_voxel) {
+                if(!gt_block) {
                     //voxel not observed in gt_map so ignore voxels that are not observed in gt map
                     voxblox::utils::setUnOccupied(voxel);
-                } else if(!voxblox::utils::isObservedVoxel(*gt_voxel)) {
+                } else if(!voxblox::utils::isObservedVoxel(gt_block->getVoxelByLinearIndex(linear_index))) {
                     voxblox::utils::setUnOccupied(voxel);
                 }
         }
@@ -164,27 +188,28 @@ void get_free_and_occupied_voxels_from_layer(const voxblox::Layer<VoxelType>& la
     size_t num_voxels_per_block = vps * vps * vps;
 
     voxblox::BlockIndexList blocks;
-    layer.getAllAllocatedBlocks(&blocks);
-    for (const voxblox::BlockIndex& block_idx : blocks) {
-        const voxblox::Block<VoxelType>& block = layer.getBlockByIndex(block_idx);
-
-        for (size_t linear_index = 0; linear_index < num_voxels_per_block; ++linear_index) {
-            // voxblox::Point coord = block.computeCoordinatesFromLinearIndex(linear_index);
-            auto voxel = block.getVoxelByLinearIndex(linear_index);
-            voxblox::VoxelIndex voxel_idx = block.computeVoxelIndexFromLinearIndex(linear_index);
-            voxblox::GlobalIndex global_voxel_idx = voxblox::getGlobalVoxelIndexFromBlockAndVoxelIndex(block_idx, voxel_idx, layer.voxels_per_side());
-
-            if (voxblox::utils::isObservedVoxel(voxel)) {
-                bool is_occupied = voxblox::utils::isOccupied(voxel, layer.voxel_size());
-
-                if (is_occupied) {
-                    occ_voxels->insert(global_voxel_idx);
-                } else {
-                    free_voxels->insert(global_voxel_idx);
+    voxblox::morton::getAllAllocatedBlocks(layer, &blocks);
+    voxblox::dispatchBlockIndexMath(vps, [&](const auto& math) {
+        for (const voxblox::BlockIndex& block_idx : blocks) {
+            const voxblox::Block<VoxelType>& block = layer.getBlockByIndex(block_idx);
+
+            for (size_t linear_index = 0; linear_index < num_voxels_per_block; ++linear_index) {
+                // voxblox::Point coord = block.computeCoordinatesFromLinearIndex(linear_index);
+                const auto& voxel = block.getVoxelByLinearIndex(linear_index);
+
+                if (voxblox::utils::isObservedVoxel(voxel)) {
+                    voxblox::GlobalIndex global_voxel_idx = math.computeGlobalIndex(block_idx, linear_index);
+                    bool is_occupied = voxblox::utils::isOccupied(voxel, layer.voxel_size());
+
+                    if (is_occupied) {
+                        occ_voxels->insert(global_voxel_idx);
+                    } else {
+                        free_voxels->insert(global_voxel_idx);
+                    }
                 }
             }
         }
-    }
+    });
 }
 
 // creates a refined ground truth layer filled with free space observed
@@ -264,35 +289,34 @@ void calculate_Intersection_difference(const voxblox::Layer<VoxelTypeA>& layer,
     size_t num_voxels_per_block = vps * vps * vps;
 
     voxblox::BlockIndexList blocks;
-    layer.getAllAllocatedBlocks(&blocks);
-    for (const voxblox::BlockIndex& index : blocks) {
-        // Iterate over all voxels in said blocks.
-        const voxblox::Block<voxblox::TsdfVoxel>& block = layer.getBlockByIndex(index);
-
-        for (size_t linear_index = 0; linear_index < num_voxels_per_block; ++linear_index) {
-            // voxblox::Point coord = block.computeCoordinatesFromLinearIndex(linear_index);
-            auto gt_voxel = block.getVoxelByLinearIndex(linear_index);
-
-            if (voxblox::utils::isOccupied(gt_voxel, layer.voxel_size())) {
-                // voxel is observed in first layer. check if it exists in other layer
-
-                // get global voxel index
-                voxblox::VoxelIndex voxel_idx = block.computeVoxelIndexFromLinearIndex(linear_index);
-                voxblox::BlockIndex block_idx = index;
-                voxblox::GlobalIndex global_voxel_idx =
-                    voxblox::getGlobalVoxelIndexFromBlockAndVoxelIndex(block_idx, voxel_idx, layer.voxels_per_side());
-
-                // see if this voxel is observed in other layer
-                auto observed_voxel = otherLayer.getVoxelPtrByGlobalIndex(global_voxel_idx);
-
-                if (observed_voxel != nullptr && voxblox::utils::isOccupied(*observed_voxel, otherLayer.voxel_size())) {
-                    intersection->emplace_back(global_voxel_idx);
-                } else {
-                    difference->emplace_back(global_voxel_idx);
+    voxblox::morton::getAllAllocatedBlocks(layer, &blocks);
+    voxblox::dispatchBlockIndexMath(vps, [&](const auto& math) {
+        for (const voxblox::BlockIndex& index : blocks) {
+            // Iterate over all voxels in said blocks.
+            const voxblox::Block<voxblox::TsdfVoxel>& block = layer.getBlockByIndex(index);
+
+            for (size_t linear_index = 0; linear_index < num_voxels_per_block; ++linear_index) {
+                // voxblox::Point coord = block.computeCoordinatesFromLinearIndex(linear_index);
+                auto gt_voxel = block.getVoxelByLinearIndex(linear_index);
+
+                if (voxblox::utils::isOccupied(gt_voxel, layer.voxel_size())) {
+                    // voxel is observed in first layer. check if it exists in other layer
+
+                    // get global voxel index
+                    voxblox::GlobalIndex global_voxel_idx = math.computeGlobalIndex(index, linear_index);
+
+                    // see if this voxel is observed in other layer
+                    auto observed_voxel = otherLayer.getVoxelPtrByGlobalIndex(global_voxel_idx);
+
+                    if (observed_voxel != nullptr && voxblox::utils::isOccupied(*observed_voxel, otherLayer.voxel_size())) {
+                        intersection->emplace_back(global_voxel_idx);
+                    } else {
+                        difference->emplace_back(global_voxel_idx);
+                    }
                 }
             }
         }
-    }
+    });
 }
 
 
@@ -361,7 +385,7 @@ void prune_outlier_voxels(const voxblox::Layer<VoxelType>& layer, voxblox::Globa
     size_t num_voxels_per_block = vps * vps * vps;
 
     voxblox::BlockIndexList blocks;
-    layer.getAllAllocatedBlocks(&blocks);
+    voxblox::morton::getAllAllocatedBlocks(layer, &blocks);
     for (const voxblox::BlockIndex& index : blocks) {
         const voxblox::Block<voxblox::TsdfVoxel>& block = layer.getBlockByIndex(index);
 
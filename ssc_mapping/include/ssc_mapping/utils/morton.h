@@ -0,0 +1,84 @@
+#ifndef SSC_MORTON_H_
+#define SSC_MORTON_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+
+namespace voxblox {
+namespace morton {
+
+// 21 bits per axis fit into a 63 bit code. Indices are shifted by kOffset
+// so that negative block indices keep their spatial order.
+constexpr int kBitsPerAxis = 21;
+constexpr int64_t kOffset = int64_t(1) << (kBitsPerAxis - 1);
+constexpr uint64_t kAxisMask = (uint64_t(1) << kBitsPerAxis) - 1;
+
+// spreads the lower 21 bits of value so that two zero bits follow each bit.
+inline uint64_t splitBy3(uint64_t value) {
+    value &= kAxisMask;
+    value = (value | value << 32) & 0x1f00000000ffffULL;
+    value = (value | value << 16) & 0x1f0000ff0000ffULL;
+    value = (value | value << 8) & 0x100f00f00f00f00fULL;
+    value = (value | value << 4) & 0x10c30c30c30c30c3ULL;
+    value = (value | value << 2) & 0x1249249249249249ULL;
+    return value;
+}
+
+// inverse of splitBy3
+inline uint64_t compactBy3(uint64_t value) {
+    value &= 0x1249249249249249ULL;
+    value = (value ^ (value >> 2)) & 0x10c30c30c30c30c3ULL;
+    value = (value ^ (value >> 4)) & 0x100f00f00f00f00fULL;
+    value = (value ^ (value >> 8)) & 0x1f0000ff0000ffULL;
+    value = (value ^ (value >> 16)) & 0x1f00000000ffffULL;
+    value = (value ^ (value >> 32)) & kAxisMask;
+    return value;
+}
+
+// Z-order code of a block (or any grid) index.
+template <typename IndexType>
+inline uint64_t encode(const IndexType& index) {
+    return splitBy3(static_cast<uint64_t>(static_cast<int64_t>(index.x()) + kOffset)) |
+           splitBy3(static_cast<uint64_t>(static_cast<int64_t>(index.y()) + kOffset)) << 1 |
+           splitBy3(static_cast<uint64_t>(static_cast<int64_t>(index.z()) + kOffset)) << 2;
+}
+
+inline BlockIndex decode(uint64_t code) {
+    return BlockIndex(static_cast<IndexElement>(static_cast<int64_t>(compactBy3(code)) - kOffset),
+                      static_cast<IndexElement>(static_cast<int64_t>(compactBy3(code >> 1)) - kOffset),
+                      static_cast<IndexElement>(static_cast<int64_t>(compactBy3(code >> 2)) - kOffset));
+}
+
+// Sorts block indices along the Z-order curve, so that consecutive blocks
+// are spatial neighbours most of the time.
+inline void sortBlocks(BlockIndexList* blocks) {
+    std::vector<std::pair<uint64_t, BlockIndex>> keyed;
+    keyed.reserve(blocks->size());
+    for (const BlockIndex& index : *blocks) {
+        keyed.emplace_back(encode(index), index);
+    }
+    std::sort(keyed.begin(), keyed.end(),
+              [](const std::pair<uint64_t, BlockIndex>& a, const std::pair<uint64_t, BlockIndex>& b) {
+                  return a.first < b.first;
+              });
+    for (size_t i = 0u; i < keyed.size(); ++i) {
+        (*blocks)[i] = keyed[i].second;
+    }
+}
+
+// Same as Layer::getAllAllocatedBlocks, but in Z-order instead of hash map order.
+template <typename VoxelType>
+inline void getAllAllocatedBlocks(const Layer<VoxelType>& layer, BlockIndexList* blocks) {
+    layer.getAllAllocatedBlocks(blocks);
+    sortBlocks(blocks);
+}
+
+}  // namespace morton
+}  // namespace voxblox
+
+#endif  // SSC_MORTON_H_
@@ -0,0 +1,41 @@
+#ifndef SSC_PARALLEL_H_
+#define SSC_PARALLEL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace voxblox {
+
+// number of worker threads to use, 0 requests all hardware threads
+inline size_t getNumberOfThreads(size_t num_threads, size_t num_items) {
+    if (num_threads == 0u) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::max<size_t>(1u, std::min(num_threads, num_items));
+}
+
+// Splits [0, num_items) into one contiguous range per thread and calls
+// fn(begin, end) for each range. Blocks until all ranges are done.
+template <typename Function>
+void parallelForRanges(size_t num_items, size_t num_threads, const Function& fn) {
+    num_threads = getNumberOfThreads(num_threads, num_items);
+    if (num_threads == 1u) {
+        fn(size_t(0u), num_items);
+        return;
+    }
+    const size_t items_per_thread = (num_items + num_threads - 1u) / num_threads;
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (size_t begin = 0u; begin < num_items; begin += items_per_thread) {
+        threads.emplace_back(fn, begin, std::min(num_items, begin + items_per_thread));
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+}  // namespace voxblox
+
+#endif  // SSC_PARALLEL_H_
@@ -1,47 +1,68 @@
 #ifndef SSC_VOXEL_UTILS_H_
 #define SSC_VOXEL_UTILS_H_
 
+#include <algorithm>
+#include <array>
+#include <iterator>
+
 #include <voxblox/interpolator/interpolator.h>
 #include <voxblox/utils/evaluation_utils.h>
 #include <voxblox/utils/voxel_utils.h>
 #include <voxblox/core/block.h>
 
+#include "ssc_mapping/core/block_summary.h"
 #include "ssc_mapping/core/voxel.h"
 #include "ssc_mapping/visualization/visualization.h"
 
 namespace voxblox {
 
-// part1 - used during upsampling. just pick largest class
-// labels among voxels. Use default class prediction.
-// like scfusion uses 0.51 for new predictions irespective
-// of probs predicted by the network.
-template <>
-inline SSCOccupancyVoxel Interpolator<SSCOccupancyVoxel>::interpVoxel(const InterpVector& q_vector,
-                                                                      const SSCOccupancyVoxel** voxels) {
-    const int MAX_CLASSES = 12;
+namespace utils {
+// Majority vote over the labels of the observed voxels. The result is
+// observed with the most frequent label if at least min_observed of the
+// voxels are observed, otherwise it is a default voxel. Observed voxels
+// without a valid label (e.g. -1 for free space) count as observed but do
+// not vote, if none of them has a label the result stays unlabeled.
+inline SSCOccupancyVoxel majorityLabelVoxel(const SSCOccupancyVoxel* const* voxels, size_t num_voxels,
+                                            size_t min_observed) {
     SSCOccupancyVoxel voxel;
 
-    uint32_t count_observed = 0;
-    std::vector<uint16_t> preds(MAX_CLASSES, 0);
-    for (int i = 0; i < q_vector.size(); ++i) {
+    size_t count_observed = 0;
+    std::array<uint16_t, SSCBlockSummary::kNumLabels> preds{};
+    for (size_t i = 0; i < num_voxels; ++i) {
         if (voxels[i]->observed) {
             count_observed++;
-            preds[voxels[i]->label]++;
+            const int label = voxels[i]->label;
+            if (label >= 0 && label < SSCBlockSummary::kNumLabels) {
+                preds[label]++;
+            }
         }
     }
 
-    // if at least of half of voxels are observed,
-    // assign the maximum class among the voxels
-    if (count_observed > q_vector.size() / 2) {
+    if (count_observed > 0 && count_observed >= min_observed) {
         auto max = std::max_element(preds.begin(), preds.end());
-        auto idx = std::distance(preds.begin(), max);
-        voxel.label = idx;
+        if (*max > 0) {
+            voxel.label = static_cast<int>(std::distance(preds.begin(), max));
+        }
         voxel.label_weight = 1.0f;
         voxel.observed = true;
     }
 
     return voxel;
 }
+}  // namespace utils
+
+// part1 - used during upsampling. just pick largest class
+// labels among voxels. Use default class prediction.
+// like scfusion uses 0.51 for new predictions irespective
+// of probs predicted by the network.
+template <>
+inline SSCOccupancyVoxel Interpolator<SSCOccupancyVoxel>::interpVoxel(const InterpVector& q_vector,
+                                                                      const SSCOccupancyVoxel** voxels) {
+    // if at least of half of voxels are observed,
+    // assign the maximum class among the voxels
+    const size_t num_voxels = q_vector.size();
+    return utils::majorityLabelVoxel(voxels, num_voxels, num_voxels / 2 + 1);
+}
 
 // part 2 merging upsampled temp layer into voxel of map layer.
 // Note; updated to use log probs and label fusion like in
@@ -0,0 +1,144 @@
+#ifndef SSC_EVAL_VISUALIZATION_H_
+#define SSC_EVAL_VISUALIZATION_H_
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <pcl/point_types.h>
+
+#include <voxblox/core/block_hash.h>
+#include <voxblox/core/color.h>
+#include <voxblox/core/common.h>
+
+#include "ssc_mapping/utils/parallel.h"
+
+namespace ssc_mapping {
+
+// How evaluation voxel sets are turned into pointclouds
+struct EvalCloudConfig {
+    float voxel_size = 0.08f;
+    // merge voxels into cells of this size, <= voxel_size keeps every voxel
+    float downsample_voxel_size = 0.0f;
+    // only keep voxels inside the box [crop_min, crop_max] if crop is set
+    bool crop = false;
+    voxblox::Point crop_min = voxblox::Point::Zero();
+    voxblox::Point crop_max = voxblox::Point::Zero();
+    // 0 uses all hardware threads
+    size_t num_threads = 0u;
+    std::string frame_id = "world";
+};
+
+inline voxblox::LongIndexElement floorDivide(voxblox::LongIndexElement value, voxblox::LongIndexElement divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+inline void setPointColor(const voxblox::Color& color, pcl::PointXYZRGB* point) {
+    point->r = color.r;
+    point->g = color.g;
+    point->b = color.b;
+}
+
+inline void setPointColor(const voxblox::Color& color, pcl::PointXYZRGBA* point) {
+    point->r = color.r;
+    point->g = color.g;
+    point->b = color.b;
+    point->a = color.a;
+}
+
+/**
+ * Creates a pointcloud of the voxel centers of the indices in a hash set
+ * accepted by filter(index), e.g. a membership test in another metric set, so
+ * intersections and differences don't have to be built just for display.
+ * The buckets of the set are split between threads, each collects its points
+ * before they are copied into the preallocated cloud. With downsampling the
+ * voxels are merged into cells of downsample_voxel_size, one point per cell.
+ */
+template <typename PointT, typename SetT, typename FilterT>
+void createPointCloudFromVoxelIndices(const SetT& voxels, const FilterT& filter, const EvalCloudConfig& config,
+                                      const voxblox::Color& color, pcl::PointCloud<PointT>* pointcloud) {
+    CHECK_NOTNULL(pointcloud);
+    pointcloud->clear();
+    pointcloud->header.frame_id = config.frame_id;
+
+    // cells of the downsampled cloud are a whole number of voxels wide
+    const voxblox::LongIndexElement cell_voxels =
+        std::max<voxblox::LongIndexElement>(1, std::lround(config.downsample_voxel_size / config.voxel_size));
+    const float cell_size = cell_voxels * config.voxel_size;
+
+    const size_t num_buckets = voxels.bucket_count();
+    const size_t num_threads = voxblox::getNumberOfThreads(config.num_threads, num_buckets);
+    std::vector<voxblox::LongIndexVector> thread_cells(num_threads);
+    const size_t buckets_per_thread = (num_buckets + num_threads - 1u) / num_threads;
+
+    voxblox::parallelForRanges(num_buckets, num_threads, [&](size_t begin, size_t end) {
+        voxblox::LongIndexVector& cells = thread_cells[begin / buckets_per_thread];
+        voxblox::LongIndexSet seen_cells;
+        for (size_t bucket = begin; bucket < end; ++bucket) {
+            for (auto it = voxels.begin(bucket); it != voxels.end(bucket); ++it) {
+                const voxblox::GlobalIndex& voxel = *it;
+                if (!filter(voxel)) {
+                    continue;
+                }
+                if (config.crop) {
+                    const voxblox::Point center =
+                        (voxel.cast<float>() + voxblox::Point::Constant(0.5f)) * config.voxel_size;
+                    if ((center.array() < config.crop_min.array()).any() ||
+                        (center.array() > config.crop_max.array()).any()) {
+                        continue;
+                    }
+                }
+                if (cell_voxels == 1) {
+                    cells.push_back(voxel);
+                    continue;
+                }
+                const voxblox::GlobalIndex cell(floorDivide(voxel.x(), cell_voxels),
+                                                floorDivide(voxel.y(), cell_voxels),
+                                                floorDivide(voxel.z(), cell_voxels));
+                if (seen_cells.insert(cell).second) {
+                    cells.push_back(cell);
+                }
+            }
+        }
+    });
+
+    if (cell_voxels > 1 && num_threads > 1u) {
+        // voxels of a cell are spread over the buckets, other threads may have collected it as well
+        voxblox::LongIndexSet seen_cells;
+        for (voxblox::LongIndexVector& cells : thread_cells) {
+            auto is_duplicate = [&](const voxblox::GlobalIndex& cell) { return !seen_cells.insert(cell).second; };
+            cells.erase(std::remove_if(cells.begin(), cells.end(), is_duplicate), cells.end());
+        }
+    }
+
+    std::vector<size_t> offsets(num_threads + 1u, 0u);
+    for (size_t i = 0u; i < num_threads; ++i) {
+        offsets[i + 1u] = offsets[i] + thread_cells[i].size();
+    }
+    pointcloud->resize(offsets.back());
+
+    voxblox::parallelForRanges(num_threads, num_threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            size_t point_idx = offsets[i];
+            for (const voxblox::GlobalIndex& cell : thread_cells[i]) {
+                PointT& point = (*pointcloud)[point_idx++];
+                point.x = cell.x() * cell_size + (cell_size / 2);
+                point.y = cell.y() * cell_size + (cell_size / 2);
+                point.z = cell.z() * cell_size + (cell_size / 2);
+                setPointColor(color, &point);
+            }
+        }
+    });
+}
+
+template <typename PointT, typename SetT>
+void createPointCloudFromVoxelIndices(const SetT& voxels, const EvalCloudConfig& config, const voxblox::Color& color,
+                                      pcl::PointCloud<PointT>* pointcloud) {
+    createPointCloudFromVoxelIndices(
+        voxels, [](const voxblox::GlobalIndex&) { return true; }, config, color, pointcloud);
+}
+
+}  // namespace ssc_mapping
+
+#endif  // SSC_EVAL_VISUALIZATION_H_
@@ -0,0 +1,75 @@
+#ifndef SSC_LOD_PYRAMID_H_
+#define SSC_LOD_PYRAMID_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <visualization_msgs/MarkerArray.h>
+
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+
+#include "ssc_mapping/core/voxel.h"
+#include "ssc_mapping/visualization/visualization_cache.h"
+
+namespace voxblox {
+
+/**
+ * Level of detail pyramid of the SSC map for visualization. Level 0 is the
+ * map itself, every coarser level doubles the voxel size and keeps the
+ * number of voxels per block side, so a block of level l covers 2x2x2 blocks
+ * of level l-1. A coarse voxel is occupied if any of its 8 children is, and
+ * takes the majority label of the occupied children.
+ *
+ * The levels are updated incrementally from the changed map blocks and
+ * cache their occupied voxel geometry like SSCVisualizationCache.
+ */
+class SSCLodPyramid {
+   public:
+    struct Config {
+        // number of coarse levels above the map resolution
+        int num_levels = 3;
+        // the level grows by one every level_distance meters from the vehicle
+        double level_distance = 10.0;
+        // publish only this level, -1 selects the levels by distance
+        int fixed_level = -1;
+    };
+
+    SSCLodPyramid(FloatingPoint voxel_size, size_t voxels_per_side, const Config& config);
+
+    // recomputes the coarse blocks covering the given map blocks on all levels
+    void updateBlocks(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks);
+
+    void clear();
+
+    int getNumberOfLevels() const { return config_.num_levels; }
+    const Config& getConfig() const { return config_; }
+
+    // level 1 to num_levels, level 0 is the map
+    const Layer<SSCOccupancyVoxel>& getLevelLayer(int level) const;
+
+    // level shown for a region at the given distance from the vehicle
+    int selectLevel(FloatingPoint distance) const;
+
+    // One cube list per level, level 0 geometry is taken from the map's visualization
+    // cache. Every top level block is shown at the level selected by its distance to center.
+    void createOccupiedNodes(const SSCVisualizationCache& map_cache, const Point& center,
+                             const std::string& frame_id, visualization_msgs::MarkerArray* marker_array) const;
+
+   private:
+    void updateCoarseBlock(const Layer<SSCOccupancyVoxel>& fine_layer, const BlockIndex& block_index,
+                           Layer<SSCOccupancyVoxel>* coarse_layer) const;
+
+    const Config config_;
+    const FloatingPoint voxel_size_;
+    const size_t voxels_per_side_;
+
+    // layers_[l - 1] and caches_[l - 1] belong to level l
+    std::vector<std::unique_ptr<Layer<SSCOccupancyVoxel>>> layers_;
+    std::vector<SSCVisualizationCache> caches_;
+};
+
+}  // namespace voxblox
+
+#endif  // SSC_LOD_PYRAMID_H_
@@ -0,0 +1,45 @@
+#ifndef SSC_MESH_INTEGRATOR_H_
+#define SSC_MESH_INTEGRATOR_H_
+
+#include <memory>
+
+#include <voxblox/core/common.h>
+#include <voxblox/mesh/mesh_layer.h>
+
+#include "ssc_mapping/core/ssc_map.h"
+#include "ssc_mapping/visualization/color_map.h"
+
+namespace voxblox {
+
+/**
+ * Extracts the occupied surface of the SSC map with marching cubes, one mesh
+ * per block. The negated log odds of observed voxels serve as the signed
+ * distance, the surface is the 0.5 occupancy probability iso surface. Cubes
+ * with an unobserved corner are skipped. Each vertex is colored by the label
+ * of the occupied cube corner nearest to it.
+ */
+class SSCMeshIntegrator {
+   public:
+    SSCMeshIntegrator(const SSCMap& ssc_map, MeshLayer* mesh_layer);
+
+    // Remeshes the given blocks along with the neighbouring blocks whose cubes
+    // reach into them. Meshes of blocks no longer in the map are emptied.
+    void generateMesh(const BlockIndexList& changed_blocks);
+
+    // Empties all meshes, they are sent as updated (empty) meshes once more.
+    void clearMesh();
+
+   private:
+    void updateMeshForBlock(const BlockIndex& block_index);
+
+    const SSCMap& ssc_map_;
+    MeshLayer* mesh_layer_;
+    SSCColorMap color_map_;
+
+    // corner offsets of a marching cube, same order as voxblox::MeshIntegrator
+    Eigen::Matrix<int, 3, 8> cube_index_offsets_;
+};
+
+}  // namespace voxblox
+
+#endif  // SSC_MESH_INTEGRATOR_H_
@@ -13,6 +13,7 @@
 
 #include "ssc_mapping/visualization/color_map.h"
 #include "ssc_mapping/core/voxel.h"
+#include "ssc_mapping/utils/morton.h"
 
 namespace voxblox {
 
@@ -21,11 +22,20 @@ bool visualizeSSCOccupancyVoxels(const SSCOccupancyVoxel& voxel, const Point& /*
 void createPointcloudFromSSCLayer(const Layer<SSCOccupancyVoxel>& layer,
                                   pcl::PointCloud<pcl::PointXYZRGB>* pointcloud);
 
+// Only visits the given blocks, e.g. the blocks whose summary reports occupied voxels.
+void createPointcloudFromSSCBlocks(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks,
+                                   pcl::PointCloud<pcl::PointXYZRGB>* pointcloud);
+
 template <typename VoxelType>
 void createOccupancyBlocksFromLayer(const Layer<VoxelType>& layer,
                                     const ShouldVisualizeVoxelColorFunctionType<VoxelType>& vis_function,
                                     const std::string& frame_id, visualization_msgs::MarkerArray* marker_array);
 
+template <typename VoxelType>
+void createOccupancyBlocksFromBlocks(const Layer<VoxelType>& layer, const BlockIndexList& blocks,
+                                     const ShouldVisualizeVoxelColorFunctionType<VoxelType>& vis_function,
+                                     const std::string& frame_id, visualization_msgs::MarkerArray* marker_array);
+
 void createOccupancyBlocksFromSSCLayer(const Layer<SSCOccupancyVoxel>& layer, const std::string& frame_id,
                                        visualization_msgs::MarkerArray* marker_array);
 
@@ -33,6 +43,15 @@ template <typename VoxelType>
 void createOccupancyBlocksFromLayer(const Layer<VoxelType>& layer,
                                     const ShouldVisualizeVoxelColorFunctionType<VoxelType>& vis_function,
                                     const std::string& frame_id, visualization_msgs::MarkerArray* marker_array) {
+    BlockIndexList blocks;
+    morton::getAllAllocatedBlocks(layer, &blocks);
+    createOccupancyBlocksFromBlocks(layer, blocks, vis_function, frame_id, marker_array);
+}
+
+template <typename VoxelType>
+void createOccupancyBlocksFromBlocks(const Layer<VoxelType>& layer, const BlockIndexList& blocks,
+                                     const ShouldVisualizeVoxelColorFunctionType<VoxelType>& vis_function,
+                                     const std::string& frame_id, visualization_msgs::MarkerArray* marker_array) {
     CHECK_NOTNULL(marker_array);
     // Cache layer settings.
     size_t vps = layer.voxels_per_side();
@@ -47,8 +66,6 @@ void createOccupancyBlocksFromLayer(const Layer<VoxelType>& layer,
     block_marker.scale.x = block_marker.scale.y = block_marker.scale.z = voxel_size;
     block_marker.action = visualization_msgs::Marker::ADD;
 
-    BlockIndexList blocks;
-    layer.getAllAllocatedBlocks(&blocks);
     for (const BlockIndex& index : blocks) {
         // Iterate over all voxels in said blocks.
         const Block<VoxelType>& block = layer.getBlockByIndex(index);
@@ -73,11 +90,12 @@ void createOccupancyBlocksFromLayer(const Layer<VoxelType>& layer,
 }  // namespace voxblox
 
 namespace ssc_mapping {
-    // Creates a pointcloud from voxel indices
+    // Creates a pointcloud from voxel indices, see eval_visualization.h for large sets
 template <typename T>
 void createPointCloudFromVoxelIndices(const T& voxels,
                                       pcl::PointCloud<pcl::PointXYZRGB>* pointcloud, const voxblox::Color& color, const float voxel_size = 0.08) {
-    for (auto voxel : voxels) {
+    pointcloud->reserve(pointcloud->size() + voxels.size());
+    for (const auto& voxel : voxels) {
         pcl::PointXYZRGB point;
         point.x = voxel.x() * voxel_size + (voxel_size/2);
         point.y = voxel.y() * voxel_size + (voxel_size/2);
@@ -94,7 +112,8 @@ void createPointCloudFromVoxelIndices(const T& voxels,
 template <typename T>
 void createPointCloudFromVoxelIndices(const T& voxels,
                                       pcl::PointCloud<pcl::PointXYZRGBA>* pointcloud, const voxblox::Color& color, const float voxel_size = 0.08) {
-    for (auto voxel : voxels) {
+    pointcloud->reserve(pointcloud->size() + voxels.size());
+    for (const auto& voxel : voxels) {
         pcl::PointXYZRGBA point;
         point.x = voxel.x() * voxel_size + (voxel_size/2);
         point.y = voxel.y() * voxel_size + (voxel_size/2);
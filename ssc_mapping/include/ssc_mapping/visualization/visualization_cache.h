@@ -0,0 +1,83 @@
+#ifndef SSC_VISUALIZATION_CACHE_H_
+#define SSC_VISUALIZATION_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include <visualization_msgs/MarkerArray.h>
+
+#include <voxblox/core/block_hash.h>
+#include <voxblox/core/color.h>
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+#include <voxblox_ros/ptcloud_vis.h>
+
+#include "ssc_mapping/core/ssc_map.h"
+#include "ssc_mapping/core/voxel.h"
+
+namespace voxblox {
+
+/**
+ * Occupied voxel geometry of the SSC map cached per block. Only blocks that
+ * changed are rebuilt, pointclouds and markers are assembled from the cache
+ * instead of visiting every voxel of the layer.
+ *
+ * For incremental marker updates every block gets a stable marker id. The
+ * blocks rebuilt since the last marker update are sent as ADD markers and
+ * blocks without occupied voxels anymore as DELETE markers.
+ */
+class SSCVisualizationCache {
+   public:
+    struct BlockGeometry {
+        AlignedVector<Point> points;
+        std::vector<Color> colors;
+    };
+    typedef AnyIndexHashMapType<BlockGeometry>::type BlockGeometryMap;
+
+    // rebuilds the geometry of the given blocks, blocks no longer in the layer are dropped
+    void updateBlocks(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks);
+
+    // same for the layer of the map, blocks whose summary has no occupied voxels are dropped without visiting them
+    void updateBlocks(const SSCMap& map, const BlockIndexList& blocks);
+
+    // same as updateBlocks but without queueing marker updates, for caches
+    // that never call createOccupiedNodeUpdates
+    void updateGeometry(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks);
+
+    // drops all geometry, the next marker update starts with a DELETEALL
+    void clear();
+
+    size_t getNumberOfBlocks() const { return block_geometry_.size(); }
+    const BlockGeometryMap& getBlockGeometry() const { return block_geometry_; }
+
+    void createPointcloud(pcl::PointCloud<pcl::PointXYZRGB>* pointcloud) const;
+
+    // single cube list of all cached voxels, same as createOccupancyBlocksFromSSCLayer
+    void createOccupiedNodes(FloatingPoint voxel_size, const std::string& frame_id,
+                             visualization_msgs::MarkerArray* marker_array) const;
+
+    // One cube list per block changed since the last call, DELETE markers for emptied blocks.
+    // Set full_update to resend all blocks, e.g. for new subscribers.
+    void createOccupiedNodeUpdates(FloatingPoint voxel_size, const std::string& frame_id, bool full_update,
+                                   visualization_msgs::MarkerArray* marker_array);
+
+   private:
+    // map is optional, its summaries let empty blocks be skipped
+    void updateGeometry(const Layer<SSCOccupancyVoxel>& layer, const SSCMap* map, const BlockIndexList& blocks);
+
+    int getMarkerId(const BlockIndex& block_index);
+
+    BlockGeometryMap block_geometry_;
+
+    // marker ids are assigned on first use and kept for the lifetime of the cache
+    AnyIndexHashMapType<int>::type marker_ids_;
+    int next_marker_id_ = 0;
+    // blocks changed since the last marker update and blocks with an ADD marker
+    IndexSet marker_blocks_;
+    IndexSet shown_blocks_;
+    bool marker_delete_all_ = false;
+};
+
+}  // namespace voxblox
+
+#endif  // SSC_VISUALIZATION_CACHE_H_
@@ -0,0 +1,68 @@
+#include "ssc_mapping/core/change_tracker.h"
+
+namespace voxblox {
+
+void SSCChangeTracker::markVoxel(const BlockIndex& block_index, size_t linear_index, size_t num_voxels) {
+    if (!track_voxels_) {
+        return;
+    }
+    std::vector<bool>& mask = pending_voxel_masks_[block_index];
+    if (mask.empty()) {
+        mask.resize(num_voxels, false);
+    }
+    mask[linear_index] = true;
+}
+
+void SSCChangeTracker::markReset() {
+    map_reset_pending_ = true;
+    pending_blocks_.clear();
+    pending_voxel_masks_.clear();
+    block_versions_.clear();
+}
+
+uint64_t SSCChangeTracker::commit() {
+    ++map_version_;
+
+    SSCChangeSet change_set;
+    change_set.map_version = map_version_;
+    change_set.map_reset = map_reset_pending_;
+    change_set.blocks.reserve(pending_blocks_.size());
+    for (const BlockIndex& block_index : pending_blocks_) {
+        change_set.blocks.push_back(block_index);
+        block_versions_[block_index] = map_version_;
+    }
+    change_set.voxel_masks.swap(pending_voxel_masks_);
+
+    pending_blocks_.clear();
+    pending_voxel_masks_.clear();
+    map_reset_pending_ = false;
+
+    for (const auto& kv : listeners_) {
+        kv.second(change_set);
+    }
+    return map_version_;
+}
+
+uint64_t SSCChangeTracker::getBlockVersion(const BlockIndex& block_index) const {
+    auto it = block_versions_.find(block_index);
+    return it != block_versions_.end() ? it->second : 0u;
+}
+
+void SSCChangeTracker::getBlocksModifiedSince(uint64_t map_version, BlockIndexList* blocks) const {
+    CHECK_NOTNULL(blocks);
+    blocks->clear();
+    for (const auto& kv : block_versions_) {
+        if (kv.second > map_version) {
+            blocks->push_back(kv.first);
+        }
+    }
+}
+
+SSCChangeTracker::ListenerId SSCChangeTracker::addListener(const Listener& listener) {
+    listeners_[next_listener_id_] = listener;
+    return next_listener_id_++;
+}
+
+void SSCChangeTracker::removeListener(ListenerId listener_id) { listeners_.erase(listener_id); }
+
+}  // namespace voxblox
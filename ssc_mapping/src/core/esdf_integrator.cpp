@@ -0,0 +1,181 @@
+#include "ssc_mapping/core/esdf_integrator.h"
+
+#include <cmath>
+#include <limits>
+
+namespace voxblox {
+
+namespace {
+
+const GlobalIndex kNeighborOffsets[26] = {
+    GlobalIndex(1, 0, 0),   GlobalIndex(1, 1, 0),   GlobalIndex(1, -1, 0),  GlobalIndex(1, 0, 1),
+    GlobalIndex(1, 1, 1),   GlobalIndex(1, -1, 1),  GlobalIndex(1, 0, -1),  GlobalIndex(1, 1, -1),
+    GlobalIndex(1, -1, -1), GlobalIndex(0, 1, 0),   GlobalIndex(0, -1, 0),  GlobalIndex(0, 0, 1),
+    GlobalIndex(0, 1, 1),   GlobalIndex(0, -1, 1),  GlobalIndex(0, 0, -1),  GlobalIndex(0, 1, -1),
+    GlobalIndex(0, -1, -1), GlobalIndex(-1, 0, 0),  GlobalIndex(-1, 1, 0),  GlobalIndex(-1, -1, 0),
+    GlobalIndex(-1, 0, 1),  GlobalIndex(-1, 1, 1),  GlobalIndex(-1, -1, 1), GlobalIndex(-1, 0, -1),
+    GlobalIndex(-1, 1, -1), GlobalIndex(-1, -1, -1)};
+
+inline GlobalIndex getSite(const GlobalIndex& global_index, const SSCEsdfVoxel& voxel) {
+    return global_index + GlobalIndex(voxel.site_offset[0], voxel.site_offset[1], voxel.site_offset[2]);
+}
+
+}  // namespace
+
+SSCEsdfIntegrator::SSCEsdfIntegrator(const Config& config, const Layer<SSCOccupancyVoxel>& ssc_layer,
+                                     Layer<SSCEsdfVoxel>* esdf_layer)
+    : config_(config),
+      ssc_layer_(ssc_layer),
+      esdf_layer_(CHECK_NOTNULL(esdf_layer)),
+      voxels_per_side_(ssc_layer.voxels_per_side()),
+      voxel_size_(ssc_layer.voxel_size()),
+      max_distance_voxels_(static_cast<LongIndexElement>(std::ceil(config.max_distance / ssc_layer.voxel_size()))) {
+    CHECK_EQ(esdf_layer_->voxels_per_side(), voxels_per_side_);
+    CHECK_GT(config_.max_distance, 0.0f);
+    CHECK_LE(max_distance_voxels_, std::numeric_limits<int8_t>::max())
+        << "max_distance spans too many voxels to store the site offsets.";
+}
+
+void SSCEsdfIntegrator::updateFromSSCLayer() {
+    clear();
+    BlockIndexList blocks;
+    ssc_layer_.getAllAllocatedBlocks(&blocks);
+    updateFromSSCBlocks(blocks);
+}
+
+void SSCEsdfIntegrator::updateFromSSCBlocks(const BlockIndexList& blocks) {
+    for (const BlockIndex& block_idx : blocks) {
+        Block<SSCOccupancyVoxel>::ConstPtr ssc_block = ssc_layer_.getBlockPtrByIndex(block_idx);
+        Block<SSCEsdfVoxel>::Ptr esdf_block = esdf_layer_->getBlockPtrByIndex(block_idx);
+        if (!esdf_block) {
+            if (!ssc_block) {
+                continue;
+            }
+            esdf_block = allocateBlock(block_idx);
+        }
+
+        // seed the waves with the voxels whose occupancy changed
+        for (size_t linear_index = 0u; linear_index < esdf_block->num_voxels(); ++linear_index) {
+            SSCEsdfVoxel& voxel = esdf_block->getVoxelByLinearIndex(linear_index);
+            const SSCOccupancyVoxel* ssc_voxel = ssc_block ? &ssc_block->getVoxelByLinearIndex(linear_index) : nullptr;
+            voxel.observed = ssc_voxel != nullptr && ssc_voxel->observed;
+            const bool occupied = voxel.observed && ssc_voxel->probability_log > config_.occupied_log_odds;
+            if (occupied == voxel.occupied) {
+                continue;
+            }
+            voxel.occupied = occupied;
+            const GlobalIndex global_idx = getGlobalVoxelIndexFromBlockAndVoxelIndex(
+                block_idx, esdf_block->computeVoxelIndexFromLinearIndex(linear_index), voxels_per_side_);
+            if (occupied) {
+                voxel.distance = 0.0f;
+                voxel.has_site = true;
+                voxel.site_offset[0] = voxel.site_offset[1] = voxel.site_offset[2] = 0;
+                lower_queue_.push_back(global_idx);
+            } else {
+                resetVoxel(&voxel);
+                raise_queue_.push_back(global_idx);
+            }
+        }
+    }
+    processRaiseQueue();
+    processLowerQueue();
+}
+
+void SSCEsdfIntegrator::processRaiseQueue() {
+    // clears the voxels whose site is not occupied anymore, voxels next to the
+    // cleared region that kept a valid site refill it in the lowering wave
+    while (!raise_queue_.empty()) {
+        const GlobalIndex global_idx = raise_queue_.front();
+        raise_queue_.pop_front();
+        for (const GlobalIndex& offset : kNeighborOffsets) {
+            const GlobalIndex neighbor_idx = global_idx + offset;
+            SSCEsdfVoxel* neighbor = getVoxel(neighbor_idx);
+            if (neighbor == nullptr || !neighbor->has_site) {
+                continue;
+            }
+            const SSCEsdfVoxel* site = getVoxel(getSite(neighbor_idx, *neighbor));
+            if (site == nullptr || !site->occupied) {
+                resetVoxel(neighbor);
+                raise_queue_.push_back(neighbor_idx);
+            } else {
+                lower_queue_.push_back(neighbor_idx);
+            }
+        }
+    }
+}
+
+void SSCEsdfIntegrator::processLowerQueue() {
+    while (!lower_queue_.empty()) {
+        const GlobalIndex global_idx = lower_queue_.front();
+        lower_queue_.pop_front();
+        const SSCEsdfVoxel* voxel = getVoxel(global_idx);
+        if (voxel == nullptr || !voxel->has_site) {
+            continue;
+        }
+        const GlobalIndex site_idx = getSite(global_idx, *voxel);
+        for (const GlobalIndex& offset : kNeighborOffsets) {
+            const GlobalIndex neighbor_idx = global_idx + offset;
+            const GlobalIndex to_site = site_idx - neighbor_idx;
+            if (to_site.cwiseAbs().maxCoeff() > max_distance_voxels_) {
+                continue;
+            }
+            const FloatingPoint distance = voxel_size_ * to_site.cast<FloatingPoint>().norm();
+            if (distance > config_.max_distance) {
+                continue;
+            }
+            SSCEsdfVoxel* neighbor = getOrAllocateVoxel(neighbor_idx);
+            if (neighbor->has_site && neighbor->distance <= distance) {
+                continue;
+            }
+            neighbor->has_site = true;
+            neighbor->distance = distance;
+            for (int i = 0; i < 3; ++i) {
+                neighbor->site_offset[i] = static_cast<int8_t>(to_site[i]);
+            }
+            lower_queue_.push_back(neighbor_idx);
+        }
+    }
+}
+
+FloatingPoint SSCEsdfIntegrator::getDistance(const GlobalIndex& global_index) const {
+    const SSCEsdfVoxel* voxel = getVoxel(global_index);
+    return voxel != nullptr && voxel->has_site ? voxel->distance : config_.max_distance;
+}
+
+FloatingPoint SSCEsdfIntegrator::getDistanceAtPosition(const Point& position) const {
+    return getDistance(getGridIndexFromPoint<GlobalIndex>(position, 1.0f / voxel_size_));
+}
+
+SSCEsdfVoxel* SSCEsdfIntegrator::getVoxel(const GlobalIndex& global_index) const {
+    BlockIndex block_idx;
+    VoxelIndex voxel_idx;
+    getBlockAndVoxelIndexFromGlobalVoxelIndex(global_index, voxels_per_side_, &block_idx, &voxel_idx);
+    Block<SSCEsdfVoxel>::Ptr block = esdf_layer_->getBlockPtrByIndex(block_idx);
+    return block ? &block->getVoxelByVoxelIndex(voxel_idx) : nullptr;
+}
+
+SSCEsdfVoxel* SSCEsdfIntegrator::getOrAllocateVoxel(const GlobalIndex& global_index) {
+    BlockIndex block_idx;
+    VoxelIndex voxel_idx;
+    getBlockAndVoxelIndexFromGlobalVoxelIndex(global_index, voxels_per_side_, &block_idx, &voxel_idx);
+    Block<SSCEsdfVoxel>::Ptr block = esdf_layer_->getBlockPtrByIndex(block_idx);
+    if (!block) {
+        block = allocateBlock(block_idx);
+    }
+    return &block->getVoxelByVoxelIndex(voxel_idx);
+}
+
+Block<SSCEsdfVoxel>::Ptr SSCEsdfIntegrator::allocateBlock(const BlockIndex& block_index) {
+    Block<SSCEsdfVoxel>::Ptr block = esdf_layer_->allocateBlockPtrByIndex(block_index);
+    for (size_t linear_index = 0u; linear_index < block->num_voxels(); ++linear_index) {
+        resetVoxel(&block->getVoxelByLinearIndex(linear_index));
+    }
+    return block;
+}
+
+void SSCEsdfIntegrator::resetVoxel(SSCEsdfVoxel* voxel) const {
+    voxel->distance = config_.max_distance;
+    voxel->has_site = false;
+}
+
+}  // namespace voxblox
@@ -1,13 +1,63 @@
 #include "ssc_mapping/core/ssc_map.h"
 
+#include <type_traits>
+
+#include "ssc_mapping/utils/block_index_math.h"
+
 namespace voxblox {
+
+namespace {
+template <typename IndexMath>
+const SSCOccupancyVoxel* lookupVoxel(const Layer<SSCOccupancyVoxel>& layer, const GlobalIndex& global_index) {
+    const IndexMath math(layer.voxels_per_side());
+    Block<SSCOccupancyVoxel>::ConstPtr block = layer.getBlockPtrByIndex(math.computeBlockIndex(global_index));
+    if (block) {
+        return &block->getVoxelByLinearIndex(math.computeLinearIndex(global_index));
+    }
+    return nullptr;
+}
+}  // namespace
+
+SSCMap::SSCMap(const Config& config)
+    : ssc_layer_(new Layer<SSCOccupancyVoxel>(config.ssc_voxel_size, config.ssc_voxels_per_side)) {
+    block_size_ = config.ssc_voxel_size * config.ssc_voxels_per_side;
+
+    // pick the lookup for the block size once
+    voxel_lookup_fn_ = dispatchBlockIndexMath(config.ssc_voxels_per_side, [](const auto& math) -> VoxelLookupFunction {
+        return &lookupVoxel<typename std::decay<decltype(math)>::type>;
+    });
+}
+
 bool SSCMap::isObserved(const Eigen::Vector3d& position) const {
-    // Get the block.
-    Block<SSCOccupancyVoxel>::Ptr block_ptr = ssc_layer_->getBlockPtrByCoordinates(position.cast<FloatingPoint>());
-    if (block_ptr) {
-        const SSCOccupancyVoxel& voxel = block_ptr->getVoxelByCoordinates(position.cast<FloatingPoint>());
-        return voxel.observed;
+    const SSCOccupancyVoxel* voxel = getVoxelPtrByCoordinates(position);
+    return voxel != nullptr && voxel->observed;
+}
+
+void SSCMap::clear() {
+    ssc_layer_->removeAllBlocks();
+    block_summaries_.clear();
+}
+
+const SSCBlockSummary* SSCMap::getBlockSummary(const BlockIndex& block_index) const {
+    auto it = block_summaries_.find(block_index);
+    return it != block_summaries_.end() ? &it->second : nullptr;
+}
+
+void SSCMap::recomputeBlockSummaries() {
+    block_summaries_.clear();
+    BlockIndexList blocks;
+    ssc_layer_->getAllAllocatedBlocks(&blocks);
+    for (const BlockIndex& block_index : blocks) {
+        block_summaries_[block_index] = computeBlockSummary(ssc_layer_->getBlockByIndex(block_index));
+    }
+}
+
+void SSCMap::recomputeBlockSummary(const BlockIndex& block_index) {
+    Block<SSCOccupancyVoxel>::ConstPtr block = ssc_layer_->getBlockPtrByIndex(block_index);
+    if (block) {
+        block_summaries_[block_index] = computeBlockSummary(*block);
+    } else {
+        block_summaries_.erase(block_index);
     }
-    return false;
 }
 }  // namespace voxblox
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "ssc_mapping/core/staged_blocks.h"
+
+namespace voxblox {
+
+Block<SSCOccupancyVoxel>::Ptr SSCStagedBlocks::getBlock(const BlockIndex& block_index, SSCBlockSummary** summary) {
+    CHECK_NOTNULL(summary);
+    auto it = blocks_.find(block_index);
+    if (it == blocks_.end()) {
+        const Layer<SSCOccupancyVoxel>& layer = map_->getSSCLayer();
+        StagedBlock staged;
+        staged.block = std::make_shared<Block<SSCOccupancyVoxel>>(
+            layer.voxels_per_side(), layer.voxel_size(),
+            getOriginPointFromGridIndex(block_index, layer.block_size()));
+        Block<SSCOccupancyVoxel>::ConstPtr block = layer.getBlockPtrByIndex(block_index);
+        if (block) {
+            for (size_t i = 0u; i < block->num_voxels(); ++i) {
+                staged.block->getVoxelByLinearIndex(i) = block->getVoxelByLinearIndex(i);
+            }
+            staged.block->set_has_data(block->has_data());
+            for (int status = 0; status < Update::kCount; ++status) {
+                staged.block->setUpdated(static_cast<Update::Status>(status),
+                                         block->updated(static_cast<Update::Status>(status)));
+            }
+        }
+        const SSCBlockSummary* block_summary = map_->getBlockSummary(block_index);
+        if (block_summary) {
+            staged.summary = *block_summary;
+        }
+        it = blocks_.emplace(block_index, std::move(staged)).first;
+    }
+    *summary = &it->second.summary;
+    return it->second.block;
+}
+
+void SSCStagedBlocks::insertBlock(const BlockIndex& block_index, const Block<SSCOccupancyVoxel>::Ptr& block) {
+    CHECK(block);
+    StagedBlock& staged = blocks_[block_index];
+    staged.block = block;
+    staged.summary = computeBlockSummary(*block);
+}
+
+void SSCStagedBlocks::getBlockIndices(BlockIndexList* blocks) const {
+    CHECK_NOTNULL(blocks);
+    blocks->clear();
+    blocks->reserve(blocks_.size());
+    for (const auto& kv : blocks_) {
+        blocks->push_back(kv.first);
+    }
+}
+
+void SSCStagedBlocks::apply() {
+    Layer<SSCOccupancyVoxel>* layer = map_->getSSCLayerPtr();
+    for (const auto& kv : blocks_) {
+        layer->removeBlock(kv.first);
+        layer->insertBlock(std::make_pair(kv.first, kv.second.block));
+        *map_->getBlockSummaryPtr(kv.first) = kv.second.summary;
+    }
+    blocks_.clear();
+}
+
+}  // namespace voxblox
@@ -37,6 +37,8 @@ class EvalData(object):
         self.time_limit = rospy.get_param(
             '~time_limit', 0.0)  # Maximum sim duration in minutes, 0 for inf
         self.gt_map_path = rospy.get_param('~gt_map_path', '/home/mansoor/flat.tsdf')
+        # ssc (voxblox protobuf) or sscz (compressed snapshot)
+        self.ssc_map_format = rospy.get_param('~ssc_map_format', 'ssc')
 
         self.start_planner_service = rospy.get_param('~start_planner', True)
 
@@ -172,7 +174,7 @@ class EvalData(object):
                              map_name + ".tsdf"))
             self.eval_ssc_service(
                 os.path.join(self.eval_directory, "ssc_maps", "maps",
-                             map_name + ".ssc"))
+                             map_name + "." + self.ssc_map_format))
 
             self.eval_n_pointclouds = 0
             self.eval_n_maps += 1
@@ -9,6 +9,7 @@
 
 #include "ssc_mapping/eval/map_eval.h"
 #include "ssc_mapping/utils/evaluation_utils.h"
+#include "ssc_mapping/io/layer_io.h"
 
 typedef voxblox::Layer<voxblox::SSCOccupancyVoxel> SSC_Layer;
 typedef voxblox::Layer<voxblox::TsdfVoxel> TSDFLayer;
@@ -132,7 +133,7 @@ int main(int argc, char** argv) {
     SSC_Layer::Ptr output_layer;
 
     voxblox::io::LoadLayer<voxblox::TsdfVoxel>(tsdf_path, &measured_layer);
-    voxblox::io::LoadLayer<voxblox::SSCOccupancyVoxel>(ssc_path, &predicted_layer);
+    voxblox::io::LoadSSCLayer(ssc_path, &predicted_layer);
 
     CHECK(measured_layer->voxel_size() == predicted_layer->voxel_size()) << "Layers should have same voxel size.";
     CHECK(measured_layer->voxels_per_side() == predicted_layer->voxels_per_side()) << "Layers should have same block size.";
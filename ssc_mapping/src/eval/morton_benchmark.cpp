@@ -0,0 +1,182 @@
+// Compares whole-map passes over blocks in hash map order against Z-order
+// on a large flat synthetic map. Reports wall time and, where the kernel
+// allows it, hardware cache misses of each pass.
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <string>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <voxblox/core/layer.h>
+#include <voxblox/core/voxel.h>
+
+#include "ssc_mapping/core/voxel.h"
+#include "ssc_mapping/utils/morton.h"
+
+DEFINE_int32(blocks_x, 128, "Number of blocks of the synthetic map along x.");
+DEFINE_int32(blocks_y, 128, "Number of blocks of the synthetic map along y.");
+DEFINE_int32(blocks_z, 2, "Number of blocks of the synthetic map along z.");
+DEFINE_int32(voxels_per_side, 16, "Voxels per block side.");
+DEFINE_int32(repetitions, 3, "Number of timed runs per traversal order.");
+
+namespace {
+
+// Counts hardware cache misses of the calling thread, if perf events are available.
+class CacheMissCounter {
+   public:
+    CacheMissCounter() {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd_ < 0) {
+            LOG(WARNING) << "perf events unavailable, only reporting wall time.";
+        }
+    }
+    ~CacheMissCounter() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    bool valid() const { return fd_ >= 0; }
+
+    void start() {
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0u;
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+                count = 0u;
+            }
+        }
+        return count;
+    }
+
+   private:
+    int fd_ = -1;
+};
+
+template <typename VoxelType>
+void fillFlatLayer(voxblox::Layer<VoxelType>* layer, const std::function<void(VoxelType*)>& fill) {
+    for (int x = -FLAGS_blocks_x / 2; x < FLAGS_blocks_x - FLAGS_blocks_x / 2; ++x) {
+        for (int y = -FLAGS_blocks_y / 2; y < FLAGS_blocks_y - FLAGS_blocks_y / 2; ++y) {
+            for (int z = 0; z < FLAGS_blocks_z; ++z) {
+                auto block = layer->allocateBlockPtrByIndex(voxblox::BlockIndex(x, y, z));
+                for (size_t i = 0u; i < block->num_voxels(); ++i) {
+                    fill(&block->getVoxelByLinearIndex(i));
+                }
+            }
+        }
+    }
+}
+
+// Visits every voxel and its six face neighbours, the access pattern of the
+// evaluation and frontier passes. Returns a checksum to keep the work alive.
+template <typename VoxelType>
+size_t neighbourPass(const voxblox::Layer<VoxelType>& layer, const voxblox::BlockIndexList& blocks,
+                     const std::function<bool(const VoxelType&)>& is_observed) {
+    static const voxblox::GlobalIndex kFaceOffsets[6] = {
+        voxblox::GlobalIndex(1, 0, 0),  voxblox::GlobalIndex(-1, 0, 0), voxblox::GlobalIndex(0, 1, 0),
+        voxblox::GlobalIndex(0, -1, 0), voxblox::GlobalIndex(0, 0, 1),  voxblox::GlobalIndex(0, 0, -1)};
+    const int vps = static_cast<int>(layer.voxels_per_side());
+    size_t checksum = 0u;
+    for (const voxblox::BlockIndex& block_idx : blocks) {
+        const voxblox::Block<VoxelType>& block = layer.getBlockByIndex(block_idx);
+        for (size_t linear_index = 0u; linear_index < block.num_voxels(); ++linear_index) {
+            if (!is_observed(block.getVoxelByLinearIndex(linear_index))) {
+                continue;
+            }
+            const voxblox::GlobalIndex global_idx = voxblox::getGlobalVoxelIndexFromBlockAndVoxelIndex(
+                block_idx, block.computeVoxelIndexFromLinearIndex(linear_index), vps);
+            for (const voxblox::GlobalIndex& offset : kFaceOffsets) {
+                const VoxelType* neighbour = layer.getVoxelPtrByGlobalIndex(global_idx + offset);
+                if (neighbour != nullptr && is_observed(*neighbour)) {
+                    ++checksum;
+                }
+            }
+        }
+    }
+    return checksum;
+}
+
+template <typename VoxelType>
+void benchmarkLayer(const std::string& name, const voxblox::Layer<VoxelType>& layer,
+                    const std::function<bool(const VoxelType&)>& is_observed) {
+    CacheMissCounter counter;
+    voxblox::BlockIndexList hash_order, z_order;
+    layer.getAllAllocatedBlocks(&hash_order);
+    voxblox::morton::getAllAllocatedBlocks(layer, &z_order);
+
+    for (const bool use_z_order : {false, true}) {
+        const voxblox::BlockIndexList& blocks = use_z_order ? z_order : hash_order;
+        double total_ms = 0.0;
+        uint64_t total_misses = 0u;
+        size_t checksum = 0u;
+        for (int i = 0; i < FLAGS_repetitions; ++i) {
+            auto t_start = std::chrono::high_resolution_clock::now();
+            counter.start();
+            checksum = neighbourPass(layer, blocks, is_observed);
+            total_misses += counter.stop();
+            auto t_end = std::chrono::high_resolution_clock::now();
+            total_ms += std::chrono::duration<double, std::milli>(t_end - t_start).count();
+        }
+        LOG(INFO) << name << (use_z_order ? " z-order:    " : " hash order: ") << total_ms / FLAGS_repetitions
+                  << " ms"
+                  << (counter.valid()
+                          ? ", " + std::to_string(total_misses / FLAGS_repetitions) + " cache misses"
+                          : std::string())
+                  << " (checksum " << checksum << ")";
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    google::InitGoogleLogging(argv[0]);
+    google::ParseCommandLineFlags(&argc, &argv, false);
+    FLAGS_alsologtostderr = true;
+
+    const size_t vps = static_cast<size_t>(FLAGS_voxels_per_side);
+    LOG(INFO) << "Flat map of " << FLAGS_blocks_x << "x" << FLAGS_blocks_y << "x" << FLAGS_blocks_z
+              << " blocks with " << vps << " voxels per side.";
+
+    {
+        voxblox::Layer<voxblox::TsdfVoxel> tsdf_layer(0.08f, vps);
+        fillFlatLayer<voxblox::TsdfVoxel>(&tsdf_layer, [](voxblox::TsdfVoxel* voxel) {
+            voxel->weight = 1.0f;
+            voxel->distance = 0.1f;
+        });
+        benchmarkLayer<voxblox::TsdfVoxel>("tsdf", tsdf_layer,
+                                           [](const voxblox::TsdfVoxel& voxel) { return voxel.weight > 1e-6; });
+    }
+    {
+        voxblox::Layer<voxblox::SSCOccupancyVoxel> ssc_layer(0.08f, vps);
+        fillFlatLayer<voxblox::SSCOccupancyVoxel>(&ssc_layer, [](voxblox::SSCOccupancyVoxel* voxel) {
+            voxel->observed = true;
+            voxel->label = 1;
+        });
+        benchmarkLayer<voxblox::SSCOccupancyVoxel>(
+            "ssc", ssc_layer, [](const voxblox::SSCOccupancyVoxel& voxel) { return voxel.observed; });
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+/////////////////////////////////////////////////////////////////////////
+// Note:
+// Rebuilds the map of a single step of a delta snapshot sequence from its
+// base snapshot and deltas and writes it as a full layer (.ssc) or
+// snapshot (.sscz).
+/////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include <voxblox/io/layer_io.h>
+
+#include "ssc_mapping/io/layer_io.h"
+#include "ssc_mapping/io/snapshot.h"
+#include "ssc_mapping/io/snapshot_manifest.h"
+
+int main(int argc, char** argv) {
+    google::InitGoogleLogging(argv[0]);
+    FLAGS_alsologtostderr = true;
+
+    if (argc != 4) {
+        LOG(ERROR) << "Usage: reconstruct_snapshot <manifest> <step|-1 for the last step> <output .ssc|.sscz>";
+        return EXIT_FAILURE;
+    }
+    const std::string manifest_path = argv[1];
+    const long step_arg = std::strtol(argv[2], nullptr, 10);
+    const std::string output_path = argv[3];
+
+    std::vector<voxblox::io::SnapshotManifestEntry> entries;
+    if (!voxblox::io::LoadSnapshotManifest(manifest_path, &entries) || entries.empty()) {
+        LOG(ERROR) << "No snapshots listed in " << manifest_path;
+        return EXIT_FAILURE;
+    }
+    const size_t step = step_arg < 0 ? entries.size() - 1u : static_cast<size_t>(step_arg);
+
+    voxblox::Layer<voxblox::SSCOccupancyVoxel>::Ptr layer;
+    if (!voxblox::io::ReconstructSSCLayer(manifest_path, step, &layer)) {
+        return EXIT_FAILURE;
+    }
+    LOG(INFO) << "Reconstructed step " << step << " (map version " << entries[step].map_version << ") with "
+              << layer->getNumberOfAllocatedBlocks() << " blocks.";
+
+    const bool saved = voxblox::io::hasExtension(output_path, voxblox::io::kSnapshotExtension)
+                           ? voxblox::io::SaveSSCSnapshot(*layer, output_path)
+                           : voxblox::io::SaveLayer(*layer, output_path);
+    if (!saved) {
+        LOG(ERROR) << "Could not write " << output_path;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
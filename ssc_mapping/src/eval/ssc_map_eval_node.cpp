@@ -8,10 +8,14 @@
  * The code expects the file path provided already exists.
  * For calculating quality metrics specifically predicted layer while considering
  * observed tsdf voxels, use ssc_map_eval_quality_node.
+ * The visualization clouds can be downsampled and cropped with the private
+ * params downsample_voxel_size, crop_min and crop_max ([x, y, z] in meters).
  */ 
 #include <tuple>
 #include "ssc_mapping/eval/map_eval.h"
 #include "ssc_mapping/utils/evaluation_utils.h"
+#include "ssc_mapping/io/layer_io.h"
+#include "ssc_mapping/visualization/eval_visualization.h"
 
 std::string get_base_file_name(std::string path) {
     return path.substr(path.find_last_of("/\\") + 1, path.find_last_of(".") - path.find_last_of("/\\") - 1);
@@ -60,7 +64,7 @@ int main(int argc, char** argv) {
         voxblox::io::LoadLayer<voxblox::TsdfVoxel>(observed_layer_path, &observed_layer);
         voxel_eval_data = get_voxel_data_from_layer(ground_truth_layer, observed_layer, refine_ob_layer);
     } else {
-        voxblox::io::LoadLayer<voxblox::SSCOccupancyVoxel>(observed_layer_path, &ssc_observed_layer);
+        voxblox::io::LoadSSCLayer(observed_layer_path, &ssc_observed_layer);
         voxel_eval_data = get_voxel_data_from_layer(ground_truth_layer, ssc_observed_layer, refine_ob_layer);
     }
 
@@ -70,8 +74,10 @@ int main(int argc, char** argv) {
     std::tie(gt_occ_voxels, gt_free_voxels, map_obs_occ_voxels, map_obs_free_voxels, gt_obs_occ, gt_obs_free,
                  gt_unobs_occ, gt_unobs_free) = voxel_eval_data;
 
+    IndexSet map_obs_occ_correct;
     auto quality_metrics = ssc_mapping::evaluation::calculate_quality_metrics(
-        gt_occ_voxels, gt_obs_occ, gt_free_voxels, gt_obs_free, map_obs_occ_voxels, map_obs_free_voxels);
+        gt_occ_voxels, gt_obs_occ, gt_free_voxels, gt_obs_free, map_obs_occ_voxels, map_obs_free_voxels,
+        publish_visualization ? &map_obs_occ_correct : nullptr);
     auto coverage_metrics = ssc_mapping::evaluation::calculate_coverage_metrics(
         gt_occ_voxels, gt_obs_occ, gt_free_voxels, gt_obs_free, map_obs_occ_voxels, map_obs_free_voxels);
 
@@ -137,35 +143,67 @@ int main(int argc, char** argv) {
         auto unobserved_free_voxels_pub =
             nh_private.advertise<pcl::PointCloud<pcl::PointXYZRGBA> >("unobserved_free_voxels", 1, true);
 
+        ssc_mapping::EvalCloudConfig cloud_config;
+        cloud_config.voxel_size = ground_truth_layer->voxel_size();
+        nh_private.param("downsample_voxel_size", cloud_config.downsample_voxel_size,
+                         cloud_config.downsample_voxel_size);
+        std::vector<float> crop_min, crop_max;
+        nh_private.param("crop_min", crop_min, crop_min);
+        nh_private.param("crop_max", crop_max, crop_max);
+        if (crop_min.size() == 3u && crop_max.size() == 3u) {
+            cloud_config.crop = true;
+            cloud_config.crop_min = voxblox::Point(crop_min[0], crop_min[1], crop_min[2]);
+            cloud_config.crop_max = voxblox::Point(crop_max[0], crop_max[1], crop_max[2]);
+        } else if (!crop_min.empty() || !crop_max.empty()) {
+            LOG(WARNING) << "crop_min and crop_max need 3 values each, not cropping.";
+        }
+        int visualization_threads = 0;
+        nh_private.param("visualization_threads", visualization_threads, visualization_threads);
+        cloud_config.num_threads = static_cast<size_t>(std::max(0, visualization_threads));
+
+        // intersections and differences are membership tests on the metric sets
+        auto in_set = [](const IndexSet& set) {
+            return [&set](const voxblox::GlobalIndex& idx) { return set.count(idx) > 0u; };
+        };
+        auto not_in_set = [](const IndexSet& set) {
+            return [&set](const voxblox::GlobalIndex& idx) { return set.count(idx) == 0u; };
+        };
+
         // publish voxels that are occupied in ground truth but are unoccupied and "observed" in observed map
         pcl::PointCloud<pcl::PointXYZRGB> pointcloud_observed_diff;
-        ssc_mapping::createPointCloudFromVoxelIndices(ssc_mapping::evaluation::set_intersection(map_obs_free_voxels, gt_occ_voxels), &pointcloud_observed_diff, voxblox::Color::Red());
+        ssc_mapping::createPointCloudFromVoxelIndices(map_obs_free_voxels, in_set(gt_occ_voxels), cloud_config,
+                                                      voxblox::Color::Red(), &pointcloud_observed_diff);
         missed_occupancy_observed_voxels_pub.publish(pointcloud_observed_diff);
 
         // publish voxels that are occupied in ground truth but are unoccupied and "not observed" in observed map
         pcl::PointCloud<pcl::PointXYZRGB> pointcloud_un_observed_occupied;
-        ssc_mapping::createPointCloudFromVoxelIndices(gt_unobs_occ, &pointcloud_un_observed_occupied, voxblox::Color::Orange());
+        ssc_mapping::createPointCloudFromVoxelIndices(gt_unobs_occ, cloud_config, voxblox::Color::Orange(),
+                                                      &pointcloud_un_observed_occupied);
         missed_occupancy_un_observed_voxels_pub.publish(pointcloud_un_observed_occupied);
 
         //correctly observed occupied voxels
         pcl::PointCloud<pcl::PointXYZRGB> pointcloud_correct_occ;
-        ssc_mapping::createPointCloudFromVoxelIndices(ssc_mapping::evaluation::set_intersection(map_obs_occ_voxels, gt_occ_voxels), &pointcloud_correct_occ, voxblox::Color::Green());
+        ssc_mapping::createPointCloudFromVoxelIndices(map_obs_occ_correct, cloud_config, voxblox::Color::Green(),
+                                                      &pointcloud_correct_occ);
         correct_occupied_voxels_observed_pub.publish(pointcloud_correct_occ);
 
         // false positive occupancy observations
         pcl::PointCloud<pcl::PointXYZRGB> pointcloud_observed_occupancy_fp;
-        ssc_mapping::createPointCloudFromVoxelIndices(ssc_mapping::evaluation::set_difference(map_obs_occ_voxels,gt_occ_voxels), &pointcloud_observed_occupancy_fp, voxblox::Color::Yellow());
+        ssc_mapping::createPointCloudFromVoxelIndices(map_obs_occ_voxels, not_in_set(map_obs_occ_correct),
+                                                      cloud_config, voxblox::Color::Yellow(),
+                                                      &pointcloud_observed_occupancy_fp);
         false_positive_observations_pub.publish(pointcloud_observed_occupancy_fp);
 
         // free voxels in ground truth map
         pcl::PointCloud<pcl::PointXYZRGB> pointcloud_free_gt_voxels;
-        ssc_mapping::createPointCloudFromVoxelIndices(gt_free_voxels, &pointcloud_free_gt_voxels,
-                                                      voxblox::Color::White());
+        ssc_mapping::createPointCloudFromVoxelIndices(gt_free_voxels, cloud_config, voxblox::Color::White(),
+                                                      &pointcloud_free_gt_voxels);
         free_gt_voxels_pub.publish(pointcloud_free_gt_voxels);
 
         // occupied voxels in ground truth map
         pcl::PointCloud<pcl::PointXYZRGB> pointcloud_occ_gt_voxels;
-        ssc_mapping::createPointCloudFromVoxelIndices(gt_occ_voxels, &pointcloud_occ_gt_voxels, voxblox::Color::Gray());
+        ssc_mapping::createPointCloudFromVoxelIndices(gt_occ_voxels, cloud_config, voxblox::Color::Gray(),
+                                                      &pointcloud_occ_gt_voxels);
         occ_gt_voxels_pub.publish(pointcloud_occ_gt_voxels);
         
         ros::spin();
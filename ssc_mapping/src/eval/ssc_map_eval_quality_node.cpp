@@ -16,6 +16,7 @@
 #include <tuple>
 #include "ssc_mapping/eval/map_eval.h"
 #include "ssc_mapping/utils/evaluation_utils.h"
+#include "ssc_mapping/io/layer_io.h"
 
 
 
@@ -54,7 +55,7 @@ int main(int argc, char** argv) {
     // load ground truth
     voxblox::io::LoadLayer<voxblox::TsdfVoxel>(gt_layer_path, &ground_truth_layer);
     voxblox::io::LoadLayer<voxblox::TsdfVoxel>(measured_layer_path, &measured_layer);
-    voxblox::io::LoadLayer<voxblox::SSCOccupancyVoxel>(observed_ssc_layer_path, &ssc_observed_layer);
+    voxblox::io::LoadSSCLayer(observed_ssc_layer_path, &ssc_observed_layer);
 
     //##########################################
     // Evaluation Metrics
@@ -0,0 +1,42 @@
+#include "ssc_mapping/io/async_snapshot_writer.h"
+
+namespace voxblox {
+namespace io {
+
+SSCAsyncSnapshotWriter::~SSCAsyncSnapshotWriter() { wait(); }
+
+void SSCAsyncSnapshotWriter::start(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks,
+                                   const WriteFunction& write_fn) {
+    if (isBusy()) {
+        LOG(WARNING) << "Waiting for the previous snapshot to be written.";
+    }
+    wait();
+
+    // the frozen layer shares the blocks with the live layer
+    std::shared_ptr<Layer<SSCOccupancyVoxel>> frozen_layer =
+        std::make_shared<Layer<SSCOccupancyVoxel>>(layer.voxel_size(), layer.voxels_per_side());
+    for (const BlockIndex& block_index : blocks) {
+        Block<SSCOccupancyVoxel>::ConstPtr block = layer.getBlockPtrByIndex(block_index);
+        if (block) {
+            frozen_layer->insertBlock(
+                std::make_pair(block_index, std::const_pointer_cast<Block<SSCOccupancyVoxel>>(block)));
+        }
+    }
+
+    done_ = false;
+    result_ = std::async(std::launch::async, [this, frozen_layer, blocks, write_fn]() {
+        const bool success = write_fn(*frozen_layer, blocks);
+        done_ = true;
+        return success;
+    });
+}
+
+bool SSCAsyncSnapshotWriter::wait() {
+    if (!result_.valid()) {
+        return true;
+    }
+    return result_.get();
+}
+
+}  // namespace io
+}  // namespace voxblox
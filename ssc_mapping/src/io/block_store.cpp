@@ -0,0 +1,291 @@
+#include "ssc_mapping/io/block_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <type_traits>
+
+namespace voxblox {
+namespace io {
+
+static_assert(std::is_trivially_copyable<SSCOccupancyVoxel>::value,
+              "SSC voxels are copied into the block store as raw memory.");
+
+namespace {
+constexpr char kStoreMagic[8] = {'S', 'S', 'C', 'S', 'T', 'O', 'R', 'E'};
+constexpr uint32_t kStoreVersion = 1u;
+constexpr uint32_t kRecordUsed = 1u;
+constexpr size_t kInitialRecords = 64u;
+}  // namespace
+
+struct SSCBlockStore::FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t voxels_per_side;
+    float voxel_size;
+    uint32_t voxel_bytes;
+    // records are only ever appended, the count is bumped after the record is complete
+    uint64_t num_records;
+    uint64_t reserved[4];
+};
+
+struct SSCBlockStore::RecordHeader {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    uint32_t flags;
+};
+
+SSCBlockStore::~SSCBlockStore() { close(); }
+
+bool SSCBlockStore::open(const std::string& file_path, Mode mode, FloatingPoint voxel_size, size_t voxels_per_side,
+                         bool truncate) {
+    close();
+    file_path_ = file_path;
+    mode_ = mode;
+
+    int flags = mode == Mode::kReadOnly ? O_RDONLY : O_RDWR | O_CREAT;
+    if (truncate && mode == Mode::kReadWrite) {
+        flags |= O_TRUNC;
+    }
+    fd_ = ::open(file_path.c_str(), flags, 0644);
+    if (fd_ < 0) {
+        LOG(ERROR) << "Could not open block store " << file_path << ": " << std::strerror(errno);
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) != 0) {
+        LOG(ERROR) << "Could not stat block store " << file_path;
+        close();
+        return false;
+    }
+
+    size_t file_size = static_cast<size_t>(file_stat.st_size);
+    if (file_size == 0u) {
+        // new store, write a header with the layer settings
+        if (mode == Mode::kReadOnly || voxel_size <= 0.0f || voxels_per_side == 0u) {
+            LOG(ERROR) << "Block store " << file_path << " is empty and can not be created.";
+            close();
+            return false;
+        }
+        FileHeader new_header;
+        std::memset(&new_header, 0, sizeof(new_header));
+        std::memcpy(new_header.magic, kStoreMagic, sizeof(kStoreMagic));
+        new_header.version = kStoreVersion;
+        new_header.voxels_per_side = static_cast<uint32_t>(voxels_per_side);
+        new_header.voxel_size = voxel_size;
+        new_header.voxel_bytes = sizeof(SSCOccupancyVoxel);
+        if (pwrite(fd_, &new_header, sizeof(new_header), 0) != sizeof(new_header)) {
+            LOG(ERROR) << "Could not write header of block store " << file_path;
+            close();
+            return false;
+        }
+        file_size = sizeof(FileHeader);
+    } else if (file_size < sizeof(FileHeader)) {
+        LOG(ERROR) << "Block store " << file_path << " is corrupted.";
+        close();
+        return false;
+    }
+
+    if (!mapFile(file_size)) {
+        close();
+        return false;
+    }
+
+    const FileHeader* file_header = header();
+    if (std::memcmp(file_header->magic, kStoreMagic, sizeof(kStoreMagic)) != 0 ||
+        file_header->version != kStoreVersion || file_header->voxel_bytes != sizeof(SSCOccupancyVoxel)) {
+        LOG(ERROR) << "File " << file_path << " is not a compatible SSC block store.";
+        close();
+        return false;
+    }
+    if (voxels_per_side > 0u && (file_header->voxels_per_side != voxels_per_side ||
+                                 std::abs(file_header->voxel_size - voxel_size) > kEpsilon)) {
+        LOG(ERROR) << "Block store " << file_path << " has a different voxel size or block size than the map.";
+        close();
+        return false;
+    }
+
+    rebuildIndex();
+    return true;
+}
+
+void SSCBlockStore::close() {
+    if (data_ != nullptr && mode_ == Mode::kReadWrite) {
+        flush(false);
+    }
+    unmapFile();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    slots_.clear();
+    capacity_ = 0u;
+}
+
+FloatingPoint SSCBlockStore::voxel_size() const { return isOpen() ? header()->voxel_size : 0.0f; }
+
+size_t SSCBlockStore::voxels_per_side() const { return isOpen() ? header()->voxels_per_side : 0u; }
+
+void SSCBlockStore::getAllStoredBlocks(BlockIndexList* blocks) const {
+    CHECK_NOTNULL(blocks);
+    blocks->clear();
+    blocks->reserve(slots_.size());
+    for (const auto& kv : slots_) {
+        blocks->push_back(kv.first);
+    }
+}
+
+bool SSCBlockStore::writeBlock(const BlockIndex& block_index, const Block<SSCOccupancyVoxel>& block) {
+    if (!isOpen() || isReadOnly()) {
+        return false;
+    }
+    CHECK_EQ(block.num_voxels(), numVoxels());
+
+    auto it = slots_.find(block_index);
+    size_t slot;
+    bool is_new_record = it == slots_.end();
+    if (is_new_record) {
+        slot = header()->num_records;
+        if (!reserveRecords(slot + 1u)) {
+            return false;
+        }
+    } else {
+        slot = it->second;
+    }
+
+    RecordHeader* block_record = record(slot);
+    std::memcpy(block_record + 1, &block.getVoxelByLinearIndex(0u), numVoxels() * sizeof(SSCOccupancyVoxel));
+
+    if (is_new_record) {
+        block_record->x = block_index.x();
+        block_record->y = block_index.y();
+        block_record->z = block_index.z();
+        block_record->flags = kRecordUsed;
+        header()->num_records = slot + 1u;
+        slots_.emplace(block_index, slot);
+    }
+    return true;
+}
+
+bool SSCBlockStore::readBlock(const BlockIndex& block_index, Block<SSCOccupancyVoxel>* block) const {
+    CHECK_NOTNULL(block);
+    auto it = slots_.find(block_index);
+    if (it == slots_.end()) {
+        return false;
+    }
+    CHECK_EQ(block->num_voxels(), numVoxels());
+    std::memcpy(&block->getVoxelByLinearIndex(0u), record(it->second) + 1, numVoxels() * sizeof(SSCOccupancyVoxel));
+    block->set_has_data(true);
+    return true;
+}
+
+size_t SSCBlockStore::writeBlocks(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks) {
+    size_t num_written = 0u;
+    for (const BlockIndex& block_index : blocks) {
+        Block<SSCOccupancyVoxel>::ConstPtr block = layer.getBlockPtrByIndex(block_index);
+        if (block && writeBlock(block_index, *block)) {
+            ++num_written;
+        }
+    }
+    return num_written;
+}
+
+bool SSCBlockStore::loadIntoLayer(Layer<SSCOccupancyVoxel>* layer) const {
+    CHECK_NOTNULL(layer);
+    if (!isOpen()) {
+        return false;
+    }
+    if (layer->voxels_per_side() != voxels_per_side() || std::abs(layer->voxel_size() - voxel_size()) > kEpsilon) {
+        LOG(ERROR) << "Block store " << file_path_ << " does not match the layer settings.";
+        return false;
+    }
+    for (const auto& kv : slots_) {
+        Block<SSCOccupancyVoxel>::Ptr block = layer->allocateBlockPtrByIndex(kv.first);
+        readBlock(kv.first, block.get());
+    }
+    return true;
+}
+
+bool SSCBlockStore::flush(bool async) {
+    if (!isOpen() || isReadOnly()) {
+        return false;
+    }
+    return msync(data_, mapped_size_, async ? MS_ASYNC : MS_SYNC) == 0;
+}
+
+bool SSCBlockStore::mapFile(size_t file_size) {
+    const int protection = mode_ == Mode::kReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* data = mmap(nullptr, file_size, protection, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED) {
+        LOG(ERROR) << "Could not map block store " << file_path_ << ": " << std::strerror(errno);
+        return false;
+    }
+    data_ = static_cast<char*>(data);
+    mapped_size_ = file_size;
+    // the header is mapped first, the record size is only known afterwards
+    capacity_ = (mapped_size_ - sizeof(FileHeader)) / recordSize();
+    return true;
+}
+
+void SSCBlockStore::unmapFile() {
+    if (data_ != nullptr) {
+        munmap(data_, mapped_size_);
+        data_ = nullptr;
+        mapped_size_ = 0u;
+    }
+}
+
+bool SSCBlockStore::reserveRecords(size_t num_records) {
+    if (num_records <= capacity_) {
+        return true;
+    }
+    const size_t new_capacity = std::max(num_records, std::max(kInitialRecords, 2u * capacity_));
+    const size_t new_size = sizeof(FileHeader) + new_capacity * recordSize();
+
+    // the new records are zero filled by the file system and therefore unused
+    flush(false);
+    unmapFile();
+    if (ftruncate(fd_, static_cast<off_t>(new_size)) != 0) {
+        LOG(ERROR) << "Could not grow block store " << file_path_ << ": " << std::strerror(errno);
+        struct stat file_stat;
+        fstat(fd_, &file_stat);
+        mapFile(static_cast<size_t>(file_stat.st_size));
+        return false;
+    }
+    return mapFile(new_size);
+}
+
+void SSCBlockStore::rebuildIndex() {
+    slots_.clear();
+    const size_t num_records = std::min<size_t>(header()->num_records, capacity_);
+    slots_.reserve(num_records);
+    for (size_t slot = 0u; slot < num_records; ++slot) {
+        const RecordHeader* block_record = record(slot);
+        if (block_record->flags & kRecordUsed) {
+            slots_.emplace(BlockIndex(block_record->x, block_record->y, block_record->z), slot);
+        }
+    }
+}
+
+SSCBlockStore::FileHeader* SSCBlockStore::header() const { return reinterpret_cast<FileHeader*>(data_); }
+
+SSCBlockStore::RecordHeader* SSCBlockStore::record(size_t slot) const {
+    return reinterpret_cast<RecordHeader*>(data_ + sizeof(FileHeader) + slot * recordSize());
+}
+
+size_t SSCBlockStore::recordSize() const { return sizeof(RecordHeader) + numVoxels() * sizeof(SSCOccupancyVoxel); }
+
+size_t SSCBlockStore::numVoxels() const {
+    const size_t vps = header()->voxels_per_side;
+    return vps * vps * vps;
+}
+
+}  // namespace io
+}  // namespace voxblox
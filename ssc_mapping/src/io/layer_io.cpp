@@ -0,0 +1,209 @@
+#include "ssc_mapping/io/layer_io.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <voxblox/Block.pb.h>
+#include <voxblox/Layer.pb.h>
+#include <voxblox/io/layer_io.h>
+
+#include "ssc_mapping/io/block_store.h"
+#include "ssc_mapping/io/snapshot.h"
+#include "ssc_mapping/utils/parallel.h"
+#include "ssc_mapping/utils/voxel_utils.h"
+
+namespace voxblox {
+namespace io {
+
+namespace {
+// read only mapping of a whole file, unmapped when going out of scope
+class MappedFile {
+   public:
+    ~MappedFile() {
+        if (data_ != nullptr) {
+            munmap(const_cast<uint8_t*>(data_), size_);
+        }
+    }
+
+    bool open(const std::string& file_path) {
+        const int fd = ::open(file_path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            LOG(ERROR) << "Could not open " << file_path << ": " << std::strerror(errno);
+            return false;
+        }
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+            LOG(ERROR) << "Could not read the size of " << file_path;
+            ::close(fd);
+            return false;
+        }
+        size_ = static_cast<size_t>(file_stat.st_size);
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            LOG(ERROR) << "Could not map " << file_path << ": " << std::strerror(errno);
+            return false;
+        }
+        madvise(data, size_, MADV_WILLNEED);
+        data_ = static_cast<const uint8_t*>(data);
+        return true;
+    }
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+   private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0u;
+};
+
+// framing as written by voxblox::utils::writeProtoMsgToStream
+bool readLittleEndian32(const uint8_t* data, size_t size, size_t* offset, uint32_t* value) {
+    if (*offset + 4u > size) {
+        return false;
+    }
+    const uint8_t* bytes = data + *offset;
+    *value = static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+             static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+    *offset += 4u;
+    return true;
+}
+
+bool readVarint32(const uint8_t* data, size_t size, size_t* offset, uint32_t* value) {
+    uint32_t result = 0u;
+    for (int shift = 0; shift < 35 && *offset < size; shift += 7) {
+        const uint8_t byte = data[(*offset)++];
+        result |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct MessageSpan {
+    size_t offset;
+    uint32_t size;
+};
+
+bool readMessageSpan(const uint8_t* data, size_t size, size_t* offset, MessageSpan* span) {
+    uint32_t message_size = 0u;
+    if (!readVarint32(data, size, offset, &message_size) || *offset + message_size > size) {
+        return false;
+    }
+    span->offset = *offset;
+    span->size = message_size;
+    *offset += message_size;
+    return true;
+}
+}  // namespace
+
+bool hasExtension(const std::string& file_path, const std::string& extension) {
+    return file_path.size() >= extension.size() &&
+           file_path.compare(file_path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+bool LoadSSCLayer(const std::string& file_path, Layer<SSCOccupancyVoxel>::Ptr* layer_ptr, size_t num_threads) {
+    CHECK_NOTNULL(layer_ptr);
+    if (hasExtension(file_path, kBlockStoreExtension)) {
+        SSCBlockStore block_store;
+        if (!block_store.open(file_path, SSCBlockStore::Mode::kReadOnly)) {
+            return false;
+        }
+        layer_ptr->reset(new Layer<SSCOccupancyVoxel>(block_store.voxel_size(), block_store.voxels_per_side()));
+        return block_store.loadIntoLayer(layer_ptr->get());
+    }
+    if (hasExtension(file_path, kSnapshotExtension)) {
+        return LoadSSCSnapshot(file_path, layer_ptr, num_threads);
+    }
+    return LoadSSCLayerParallel(file_path, layer_ptr, num_threads);
+}
+
+bool LoadSSCLayerParallel(const std::string& file_path, Layer<SSCOccupancyVoxel>::Ptr* layer_ptr,
+                          size_t num_threads) {
+    CHECK_NOTNULL(layer_ptr);
+    MappedFile file;
+    if (!file.open(file_path)) {
+        return false;
+    }
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+
+    // message count (layer header plus blocks) followed by the layer header
+    size_t offset = 0u;
+    uint32_t num_messages = 0u;
+    MessageSpan layer_span;
+    if (!readLittleEndian32(data, size, &offset, &num_messages) || num_messages == 0u ||
+        !readMessageSpan(data, size, &offset, &layer_span)) {
+        LOG(ERROR) << "Could not read the layer header of " << file_path;
+        return false;
+    }
+    LayerProto layer_proto;
+    if (!layer_proto.ParseFromArray(data + layer_span.offset, static_cast<int>(layer_span.size))) {
+        LOG(ERROR) << "Could not parse the layer header of " << file_path;
+        return false;
+    }
+    if (layer_proto.type() != getVoxelType<SSCOccupancyVoxel>()) {
+        LOG(ERROR) << "The layer in " << file_path << " is of type " << layer_proto.type() << ", expected "
+                   << getVoxelType<SSCOccupancyVoxel>();
+        return false;
+    }
+    Layer<SSCOccupancyVoxel>::Ptr layer(new Layer<SSCOccupancyVoxel>(layer_proto));
+
+    // every message takes at least its length prefix byte, check the count from the file before allocating
+    if (num_messages - 1u > size - offset) {
+        LOG(ERROR) << "The message count of " << file_path << " exceeds its size, the file is truncated or corrupt.";
+        return false;
+    }
+
+    // the framing has to be walked sequentially, it is cheap compared to the decode
+    std::vector<MessageSpan> block_spans(num_messages - 1u);
+    for (MessageSpan& span : block_spans) {
+        if (!readMessageSpan(data, size, &offset, &span)) {
+            LOG(ERROR) << "Truncated block message in " << file_path;
+            return false;
+        }
+    }
+
+    // each thread decodes a contiguous range of blocks into its own slots
+    std::vector<Block<SSCOccupancyVoxel>::Ptr> blocks(block_spans.size());
+    std::atomic<bool> failed(false);
+    parallelForRanges(blocks.size(), num_threads, [&](size_t begin, size_t end) {
+        BlockProto block_proto;
+        for (size_t i = begin; i < end && !failed; ++i) {
+            if (!block_proto.ParseFromArray(data + block_spans[i].offset, static_cast<int>(block_spans[i].size)) ||
+                !layer->isCompatible(block_proto)) {
+                failed = true;
+                return;
+            }
+            blocks[i].reset(new Block<SSCOccupancyVoxel>(block_proto));
+        }
+    });
+    if (failed) {
+        LOG(ERROR) << "Could not decode the blocks of " << file_path;
+        return false;
+    }
+
+    for (const Block<SSCOccupancyVoxel>::Ptr& block : blocks) {
+        const BlockIndex block_index = getGridIndexFromOriginPoint<BlockIndex>(block->origin(), layer->block_size_inv());
+        if (layer->getBlockPtrByIndex(block_index)) {
+            LOG(WARNING) << "Duplicate block " << block_index.transpose() << " in " << file_path;
+            continue;
+        }
+        layer->insertBlock(std::make_pair(block_index, block));
+    }
+    *layer_ptr = layer;
+    return true;
+}
+
+}  // namespace io
+}  // namespace voxblox
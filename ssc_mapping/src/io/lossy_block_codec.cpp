@@ -0,0 +1,156 @@
+#include "ssc_mapping/io/lossy_block_codec.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace voxblox {
+namespace io {
+
+namespace {
+constexpr uint8_t kBlockHasData = 1u << 0;
+
+inline void setBit(size_t bit, size_t offset, std::vector<uint8_t>* buffer) {
+    (*buffer)[offset + bit / 8u] |= 1u << (bit % 8u);
+}
+
+inline bool getBit(const std::vector<uint8_t>& buffer, size_t offset, size_t bit) {
+    return (buffer[offset + bit / 8u] & (1u << (bit % 8u))) != 0u;
+}
+
+inline size_t bitmapSize(size_t num_bits) { return (num_bits + 7u) / 8u; }
+}  // namespace
+
+bool encodeSSCBlockLossy(const Block<SSCOccupancyVoxel>& block, const LossyBlockCodecConfig& config,
+                         std::vector<uint8_t>* compressed, uint32_t* raw_size) {
+    CHECK_NOTNULL(compressed);
+    CHECK_NOTNULL(raw_size);
+    CHECK_GT(config.log_odds_step, 0.0f);
+    const size_t num_voxels = block.num_voxels();
+
+    std::vector<size_t> observed, confident, quantized;
+    for (size_t i = 0u; i < num_voxels; ++i) {
+        const SSCOccupancyVoxel& voxel = block.getVoxelByLinearIndex(i);
+        if (!voxel.observed) {
+            continue;
+        }
+        observed.push_back(i);
+        if (std::abs(voxel.probability_log) >= config.confident_log_odds) {
+            confident.push_back(i);
+        } else {
+            quantized.push_back(i);
+        }
+    }
+
+    std::vector<uint8_t> packed(1u + 2u * sizeof(float), 0u);
+    packed[0] = block.has_data() ? kBlockHasData : 0u;
+    memcpy(&packed[1], &config.log_odds_step, sizeof(float));
+    memcpy(&packed[1 + sizeof(float)], &config.confident_log_odds, sizeof(float));
+
+    const size_t observed_offset = packed.size();
+    packed.resize(packed.size() + bitmapSize(num_voxels), 0u);
+    for (size_t i : observed) {
+        setBit(i, observed_offset, &packed);
+    }
+    const size_t confident_offset = packed.size();
+    packed.resize(packed.size() + bitmapSize(observed.size()), 0u);
+    for (size_t j = 0u; j < observed.size(); ++j) {
+        if (std::abs(block.getVoxelByLinearIndex(observed[j]).probability_log) >= config.confident_log_odds) {
+            setBit(j, confident_offset, &packed);
+        }
+    }
+    const size_t occupied_offset = packed.size();
+    packed.resize(packed.size() + bitmapSize(confident.size()), 0u);
+    for (size_t j = 0u; j < confident.size(); ++j) {
+        if (block.getVoxelByLinearIndex(confident[j]).probability_log > 0.0f) {
+            setBit(j, occupied_offset, &packed);
+        }
+    }
+
+    // labels are shifted by one so that the unknown label -1 fits into a byte
+    for (size_t i : observed) {
+        packed.push_back(static_cast<uint8_t>(std::min(std::max(block.getVoxelByLinearIndex(i).label + 1, 0), 255)));
+    }
+    for (size_t i : quantized) {
+        const float steps = std::round(block.getVoxelByLinearIndex(i).probability_log / config.log_odds_step);
+        packed.push_back(static_cast<uint8_t>(static_cast<int8_t>(std::min(std::max(steps, -127.0f), 127.0f))));
+    }
+
+    uLongf compressed_size = compressBound(packed.size());
+    compressed->resize(compressed_size);
+    if (compress2(compressed->data(), &compressed_size, packed.data(), packed.size(), config.compression_level) !=
+        Z_OK) {
+        return false;
+    }
+    compressed->resize(compressed_size);
+    *raw_size = static_cast<uint32_t>(packed.size());
+    return true;
+}
+
+bool decodeSSCBlockLossy(const uint8_t* compressed, size_t compressed_size, size_t raw_size,
+                         Block<SSCOccupancyVoxel>* block) {
+    CHECK_NOTNULL(block);
+    std::vector<uint8_t> packed(raw_size);
+    uLongf packed_size = raw_size;
+    if (raw_size < 1u + 2u * sizeof(float) ||
+        uncompress(packed.data(), &packed_size, compressed, compressed_size) != Z_OK || packed_size != raw_size) {
+        return false;
+    }
+
+    const size_t num_voxels = block->num_voxels();
+    float log_odds_step, confident_log_odds;
+    memcpy(&log_odds_step, &packed[1], sizeof(float));
+    memcpy(&confident_log_odds, &packed[1 + sizeof(float)], sizeof(float));
+    size_t offset = 1u + 2u * sizeof(float);
+
+    const size_t observed_offset = offset;
+    offset += bitmapSize(num_voxels);
+    if (offset > packed.size()) {
+        return false;
+    }
+    std::vector<size_t> observed;
+    for (size_t i = 0u; i < num_voxels; ++i) {
+        if (getBit(packed, observed_offset, i)) {
+            observed.push_back(i);
+        }
+    }
+    const size_t confident_offset = offset;
+    offset += bitmapSize(observed.size());
+    if (offset > packed.size()) {
+        return false;
+    }
+    size_t num_confident = 0u;
+    for (size_t j = 0u; j < observed.size(); ++j) {
+        num_confident += getBit(packed, confident_offset, j) ? 1u : 0u;
+    }
+    const size_t occupied_offset = offset;
+    offset += bitmapSize(num_confident);
+    const size_t label_offset = offset;
+    offset += observed.size();
+    if (offset + observed.size() - num_confident != packed.size()) {
+        return false;
+    }
+
+    for (size_t i = 0u; i < num_voxels; ++i) {
+        block->getVoxelByLinearIndex(i) = SSCOccupancyVoxel();
+    }
+    size_t confident_index = 0u;
+    for (size_t j = 0u; j < observed.size(); ++j) {
+        SSCOccupancyVoxel& voxel = block->getVoxelByLinearIndex(observed[j]);
+        voxel.observed = true;
+        voxel.label = static_cast<int>(packed[label_offset + j]) - 1;
+        if (getBit(packed, confident_offset, j)) {
+            voxel.probability_log =
+                getBit(packed, occupied_offset, confident_index++) ? confident_log_odds : -confident_log_odds;
+        } else {
+            voxel.probability_log = static_cast<int8_t>(packed[offset++]) * log_odds_step;
+        }
+    }
+    block->set_has_data((packed[0] & kBlockHasData) != 0u);
+    return true;
+}
+
+}  // namespace io
+}  // namespace voxblox
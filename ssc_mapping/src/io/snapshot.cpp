@@ -0,0 +1,439 @@
+#include "ssc_mapping/io/snapshot.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "ssc_mapping/io/snapshot_manifest.h"
+#include "ssc_mapping/utils/parallel.h"
+
+namespace voxblox {
+namespace io {
+
+namespace {
+constexpr char kSnapshotMagic[8] = {'S', 'S', 'C', 'S', 'N', 'A', 'P', 'Z'};
+constexpr uint32_t kSnapshotVersion = 1u;
+
+// snapshot flags
+constexpr uint32_t kSnapshotDelta = 1u << 0;
+
+// block flags of the packed payload
+constexpr uint8_t kBlockHasData = 1u << 0;
+constexpr uint8_t kBlockWideLabels = 1u << 1;
+
+// largest block size accepted from a file, the maps use 16
+constexpr uint32_t kMaxVoxelsPerSide = 64u;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t voxels_per_side;
+    float voxel_size;
+    uint32_t flags;
+    uint64_t num_blocks;
+    uint64_t index_offset;
+};
+
+struct SnapshotIndexEntry {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    uint32_t raw_size;
+    uint64_t offset;
+    uint32_t compressed_size;
+    uint32_t reserved;
+};
+
+inline bool isDefaultVoxel(const SSCOccupancyVoxel& voxel) {
+    static const SSCOccupancyVoxel kDefaultVoxel;
+    return voxel.observed == kDefaultVoxel.observed && voxel.label == kDefaultVoxel.label &&
+           voxel.probability_log == kDefaultVoxel.probability_log &&
+           voxel.label_weight == kDefaultVoxel.label_weight;
+}
+
+template <typename T>
+inline void appendValue(const T& value, std::vector<uint8_t>* buffer) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer->insert(buffer->end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+inline bool readValue(const std::vector<uint8_t>& buffer, size_t* offset, T* value) {
+    if (*offset + sizeof(T) > buffer.size()) {
+        return false;
+    }
+    memcpy(value, buffer.data() + *offset, sizeof(T));
+    *offset += sizeof(T);
+    return true;
+}
+
+bool preadAll(int fd, uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0u) {
+        const ssize_t num_read = pread(fd, data, size, static_cast<off_t>(offset));
+        if (num_read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (num_read <= 0) {
+            return false;
+        }
+        data += num_read;
+        size -= static_cast<size_t>(num_read);
+        offset += static_cast<uint64_t>(num_read);
+    }
+    return true;
+}
+}  // namespace
+
+bool encodeSSCBlock(const Block<SSCOccupancyVoxel>& block, std::vector<uint8_t>* compressed, uint32_t* raw_size) {
+    CHECK_NOTNULL(compressed);
+    CHECK_NOTNULL(raw_size);
+    const size_t num_voxels = block.num_voxels();
+
+    // voxels with any non-default field are stored, everything else is implied
+    std::vector<size_t> stored;
+    bool wide_labels = false;
+    for (size_t i = 0u; i < num_voxels; ++i) {
+        const SSCOccupancyVoxel& voxel = block.getVoxelByLinearIndex(i);
+        if (!isDefaultVoxel(voxel)) {
+            stored.push_back(i);
+            wide_labels = wide_labels || voxel.label < -1 || voxel.label > 254;
+        }
+    }
+
+    std::vector<uint8_t> packed;
+    packed.reserve(1u + (num_voxels + 7u) / 8u + stored.size() * 10u);
+    packed.push_back((block.has_data() ? kBlockHasData : 0u) | (wide_labels ? kBlockWideLabels : 0u));
+
+    const size_t stored_bitmap_offset = packed.size();
+    packed.resize(packed.size() + (num_voxels + 7u) / 8u, 0u);
+    for (size_t i : stored) {
+        packed[stored_bitmap_offset + i / 8u] |= 1u << (i % 8u);
+    }
+
+    const size_t observed_bitmap_offset = packed.size();
+    packed.resize(packed.size() + (stored.size() + 7u) / 8u, 0u);
+    for (size_t j = 0u; j < stored.size(); ++j) {
+        if (block.getVoxelByLinearIndex(stored[j]).observed) {
+            packed[observed_bitmap_offset + j / 8u] |= 1u << (j % 8u);
+        }
+    }
+
+    // labels are shifted by one so that the unknown label -1 fits into a byte
+    for (size_t i : stored) {
+        const int label = block.getVoxelByLinearIndex(i).label;
+        if (wide_labels) {
+            appendValue<int32_t>(label, &packed);
+        } else {
+            packed.push_back(static_cast<uint8_t>(label + 1));
+        }
+    }
+    for (size_t i : stored) {
+        appendValue<float>(block.getVoxelByLinearIndex(i).probability_log, &packed);
+    }
+    for (size_t i : stored) {
+        appendValue<float>(block.getVoxelByLinearIndex(i).label_weight, &packed);
+    }
+
+    uLongf compressed_size = compressBound(packed.size());
+    compressed->resize(compressed_size);
+    if (compress2(compressed->data(), &compressed_size, packed.data(), packed.size(), Z_BEST_SPEED) != Z_OK) {
+        return false;
+    }
+    compressed->resize(compressed_size);
+    *raw_size = static_cast<uint32_t>(packed.size());
+    return true;
+}
+
+bool decodeSSCBlock(const uint8_t* compressed, size_t compressed_size, size_t raw_size,
+                    Block<SSCOccupancyVoxel>* block) {
+    CHECK_NOTNULL(block);
+    std::vector<uint8_t> packed(raw_size);
+    uLongf packed_size = raw_size;
+    if (uncompress(packed.data(), &packed_size, compressed, compressed_size) != Z_OK || packed_size != raw_size ||
+        raw_size == 0u) {
+        return false;
+    }
+
+    const size_t num_voxels = block->num_voxels();
+    const uint8_t flags = packed[0];
+    size_t offset = 1u;
+    const size_t stored_bitmap_offset = offset;
+    offset += (num_voxels + 7u) / 8u;
+    if (offset > packed.size()) {
+        return false;
+    }
+
+    std::vector<size_t> stored;
+    for (size_t i = 0u; i < num_voxels; ++i) {
+        if (packed[stored_bitmap_offset + i / 8u] & (1u << (i % 8u))) {
+            stored.push_back(i);
+        }
+    }
+    const size_t observed_bitmap_offset = offset;
+    offset += (stored.size() + 7u) / 8u;
+    const size_t label_bytes = (flags & kBlockWideLabels) ? sizeof(int32_t) : 1u;
+    if (offset + stored.size() * (label_bytes + 2u * sizeof(float)) != packed.size()) {
+        return false;
+    }
+
+    for (size_t i = 0u; i < num_voxels; ++i) {
+        block->getVoxelByLinearIndex(i) = SSCOccupancyVoxel();
+    }
+    for (size_t j = 0u; j < stored.size(); ++j) {
+        SSCOccupancyVoxel& voxel = block->getVoxelByLinearIndex(stored[j]);
+        voxel.observed = (packed[observed_bitmap_offset + j / 8u] & (1u << (j % 8u))) != 0u;
+        if (flags & kBlockWideLabels) {
+            int32_t label;
+            readValue(packed, &offset, &label);
+            voxel.label = label;
+        } else {
+            voxel.label = static_cast<int>(packed[offset++]) - 1;
+        }
+    }
+    for (size_t i : stored) {
+        readValue(packed, &offset, &block->getVoxelByLinearIndex(i).probability_log);
+    }
+    for (size_t i : stored) {
+        readValue(packed, &offset, &block->getVoxelByLinearIndex(i).label_weight);
+    }
+    block->set_has_data((flags & kBlockHasData) != 0u);
+    return true;
+}
+
+bool SaveSSCSnapshot(const Layer<SSCOccupancyVoxel>& layer, const std::string& file_path, size_t num_threads) {
+    BlockIndexList blocks;
+    layer.getAllAllocatedBlocks(&blocks);
+    return SaveSSCSnapshot(layer, blocks, file_path, num_threads);
+}
+
+bool SaveSSCSnapshot(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks,
+                     const std::string& file_path, size_t num_threads, bool is_delta) {
+    // encode in parallel, blocks are independent
+    std::vector<std::vector<uint8_t>> payloads(blocks.size());
+    std::vector<uint32_t> raw_sizes(blocks.size(), 0u);
+    std::atomic<bool> failed(false);
+    parallelForRanges(blocks.size(), num_threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end && !failed; ++i) {
+            Block<SSCOccupancyVoxel>::ConstPtr block = layer.getBlockPtrByIndex(blocks[i]);
+            if (!block || !encodeSSCBlock(*block, &payloads[i], &raw_sizes[i])) {
+                failed = true;
+            }
+        }
+    });
+    if (failed) {
+        LOG(ERROR) << "Could not encode the blocks of snapshot " << file_path;
+        return false;
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kSnapshotVersion;
+    header.voxels_per_side = static_cast<uint32_t>(layer.voxels_per_side());
+    header.voxel_size = layer.voxel_size();
+    header.flags = is_delta ? kSnapshotDelta : 0u;
+    header.num_blocks = blocks.size();
+
+    std::vector<SnapshotIndexEntry> index(blocks.size());
+    uint64_t offset = sizeof(SnapshotHeader);
+    for (size_t i = 0u; i < blocks.size(); ++i) {
+        SnapshotIndexEntry& entry = index[i];
+        memset(&entry, 0, sizeof(entry));
+        entry.x = blocks[i].x();
+        entry.y = blocks[i].y();
+        entry.z = blocks[i].z();
+        entry.raw_size = raw_sizes[i];
+        entry.offset = offset;
+        entry.compressed_size = static_cast<uint32_t>(payloads[i].size());
+        offset += payloads[i].size();
+    }
+    header.index_offset = offset;
+
+    // readers never see a partially written snapshot
+    const std::string tmp_path = file_path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            LOG(ERROR) << "Could not open " << tmp_path << " for writing.";
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const std::vector<uint8_t>& payload : payloads) {
+            out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+        }
+        out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(SnapshotIndexEntry));
+        if (!out.good()) {
+            LOG(ERROR) << "Could not write snapshot " << tmp_path;
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+        LOG(ERROR) << "Could not move snapshot to " << file_path << ": " << std::strerror(errno);
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+SSCSnapshotReader::~SSCSnapshotReader() { close(); }
+
+bool SSCSnapshotReader::open(const std::string& file_path) {
+    close();
+    file_path_ = file_path;
+    fd_ = ::open(file_path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        LOG(ERROR) << "Could not open snapshot " << file_path << ": " << std::strerror(errno);
+        return false;
+    }
+
+    SnapshotHeader header;
+    if (!preadAll(fd_, reinterpret_cast<uint8_t*>(&header), sizeof(header), 0u) ||
+        memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 || header.version != kSnapshotVersion) {
+        LOG(ERROR) << file_path << " is not an SSC snapshot of version " << kSnapshotVersion;
+        close();
+        return false;
+    }
+    if (header.voxels_per_side == 0u || header.voxels_per_side > kMaxVoxelsPerSide ||
+        (header.voxels_per_side & (header.voxels_per_side - 1u)) != 0u || !(header.voxel_size > 0.0f) ||
+        !std::isfinite(header.voxel_size)) {
+        LOG(ERROR) << file_path << " has an invalid layout of " << header.voxels_per_side << " voxels per side of size "
+                   << header.voxel_size << ", the file is corrupt.";
+        close();
+        return false;
+    }
+    voxel_size_ = header.voxel_size;
+    voxels_per_side_ = header.voxels_per_side;
+    is_delta_ = (header.flags & kSnapshotDelta) != 0u;
+
+    // the counts come from the file, check them before allocating anything
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) != 0) {
+        LOG(ERROR) << "Could not stat snapshot " << file_path << ": " << std::strerror(errno);
+        close();
+        return false;
+    }
+    const uint64_t file_size = static_cast<uint64_t>(file_stat.st_size);
+    if (header.index_offset < sizeof(header) || header.index_offset > file_size ||
+        header.num_blocks > (file_size - header.index_offset) / sizeof(SnapshotIndexEntry)) {
+        LOG(ERROR) << "The block index of " << file_path << " does not fit the file, it is truncated or corrupt.";
+        close();
+        return false;
+    }
+
+    std::vector<SnapshotIndexEntry> index(header.num_blocks);
+    if (!preadAll(fd_, reinterpret_cast<uint8_t*>(index.data()), index.size() * sizeof(SnapshotIndexEntry),
+                  header.index_offset)) {
+        LOG(ERROR) << "Could not read the block index of " << file_path;
+        close();
+        return false;
+    }
+    // largest packed block: flags, both bitmaps and wide labels for every voxel
+    const uint64_t num_voxels = static_cast<uint64_t>(voxels_per_side_) * voxels_per_side_ * voxels_per_side_;
+    const uint64_t max_raw_size = 1u + 2u * ((num_voxels + 7u) / 8u) + num_voxels * 12u;
+    entries_.reserve(index.size());
+    for (const SnapshotIndexEntry& entry : index) {
+        if (entry.offset < sizeof(header) || entry.offset > header.index_offset ||
+            entry.compressed_size > header.index_offset - entry.offset || entry.raw_size > max_raw_size) {
+            LOG(ERROR) << "Block index entry of " << file_path << " is out of range, the file is corrupt.";
+            close();
+            return false;
+        }
+        entry_lookup_[BlockIndex(entry.x, entry.y, entry.z)] = entries_.size();
+        entries_.push_back({BlockIndex(entry.x, entry.y, entry.z), entry.offset, entry.compressed_size, entry.raw_size});
+    }
+    return true;
+}
+
+void SSCSnapshotReader::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    is_delta_ = false;
+    entries_.clear();
+    entry_lookup_.clear();
+}
+
+void SSCSnapshotReader::getAllBlocks(BlockIndexList* blocks) const {
+    CHECK_NOTNULL(blocks);
+    blocks->clear();
+    blocks->reserve(entries_.size());
+    for (const IndexEntry& entry : entries_) {
+        blocks->push_back(entry.block_index);
+    }
+}
+
+bool SSCSnapshotReader::readBlock(const BlockIndex& block_index, Block<SSCOccupancyVoxel>* block) const {
+    auto it = entry_lookup_.find(block_index);
+    if (it == entry_lookup_.end()) {
+        return false;
+    }
+    return readEntry(entries_[it->second], block);
+}
+
+bool SSCSnapshotReader::readEntry(const IndexEntry& entry, Block<SSCOccupancyVoxel>* block) const {
+    CHECK_NOTNULL(block);
+    if (block->voxels_per_side() != voxels_per_side_) {
+        return false;
+    }
+    std::vector<uint8_t> compressed(entry.compressed_size);
+    return preadAll(fd_, compressed.data(), compressed.size(), entry.offset) &&
+           decodeSSCBlock(compressed.data(), compressed.size(), entry.raw_size, block);
+}
+
+bool SSCSnapshotReader::loadIntoLayer(Layer<SSCOccupancyVoxel>* layer, size_t num_threads) const {
+    CHECK_NOTNULL(layer);
+    if (!isOpen() || layer->voxels_per_side() != voxels_per_side_) {
+        return false;
+    }
+
+    std::vector<Block<SSCOccupancyVoxel>::Ptr> blocks(entries_.size());
+    std::atomic<bool> failed(false);
+    parallelForRanges(entries_.size(), num_threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end && !failed; ++i) {
+            blocks[i].reset(new Block<SSCOccupancyVoxel>(
+                voxels_per_side_, voxel_size_,
+                getOriginPointFromGridIndex(entries_[i].block_index, layer->block_size())));
+            if (!readEntry(entries_[i], blocks[i].get())) {
+                failed = true;
+            }
+        }
+    });
+    if (failed) {
+        LOG(ERROR) << "Could not decode the blocks of snapshot " << file_path_;
+        return false;
+    }
+
+    for (size_t i = 0u; i < entries_.size(); ++i) {
+        layer->removeBlock(entries_[i].block_index);
+        layer->insertBlock(std::make_pair(entries_[i].block_index, blocks[i]));
+    }
+    return true;
+}
+
+bool LoadSSCSnapshot(const std::string& file_path, Layer<SSCOccupancyVoxel>::Ptr* layer_ptr, size_t num_threads) {
+    CHECK_NOTNULL(layer_ptr);
+    SSCSnapshotReader reader;
+    if (!reader.open(file_path)) {
+        return false;
+    }
+    if (reader.isDelta()) {
+        // a delta alone is not a map, rebuild it from its manifest
+        reader.close();
+        return ReconstructSSCLayerFromSnapshot(file_path, layer_ptr, num_threads);
+    }
+    layer_ptr->reset(new Layer<SSCOccupancyVoxel>(reader.voxel_size(), reader.voxels_per_side()));
+    return reader.loadIntoLayer(layer_ptr->get(), num_threads);
+}
+
+}  // namespace io
+}  // namespace voxblox
@@ -0,0 +1,127 @@
+#include "ssc_mapping/io/snapshot_manifest.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "ssc_mapping/io/snapshot.h"
+
+namespace voxblox {
+namespace io {
+
+namespace {
+const std::string kBaseTag = "base";
+const std::string kDeltaTag = "delta";
+}  // namespace
+
+std::string getDirectory(const std::string& file_path) {
+    const size_t separator = file_path.find_last_of('/');
+    return separator == std::string::npos ? std::string() : file_path.substr(0u, separator + 1u);
+}
+
+std::string getFileName(const std::string& file_path) {
+    const size_t separator = file_path.find_last_of('/');
+    return separator == std::string::npos ? file_path : file_path.substr(separator + 1u);
+}
+
+std::string getSnapshotManifestPath(const std::string& snapshot_path) {
+    return getDirectory(snapshot_path) + kSnapshotManifestName;
+}
+
+bool LoadSnapshotManifest(const std::string& manifest_path, std::vector<SnapshotManifestEntry>* entries) {
+    CHECK_NOTNULL(entries);
+    entries->clear();
+    std::ifstream in(manifest_path);
+    if (!in.is_open()) {
+        LOG(ERROR) << "Could not open snapshot manifest " << manifest_path;
+        return false;
+    }
+    std::string line;
+    size_t line_number = 0u;
+    while (std::getline(in, line)) {
+        ++line_number;
+        if (line.empty()) {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string tag;
+        SnapshotManifestEntry entry;
+        if (!(fields >> tag >> entry.file_name >> entry.map_version) || (tag != kBaseTag && tag != kDeltaTag)) {
+            LOG(ERROR) << "Malformed line " << line_number << " in snapshot manifest " << manifest_path;
+            return false;
+        }
+        entry.is_delta = tag == kDeltaTag;
+        entries->push_back(entry);
+    }
+    return true;
+}
+
+bool AppendSnapshotManifestEntry(const std::string& manifest_path, const SnapshotManifestEntry& entry) {
+    std::ofstream out(manifest_path, std::ios::app);
+    out << (entry.is_delta ? kDeltaTag : kBaseTag) << " " << entry.file_name << " " << entry.map_version << "\n";
+    if (!out.good()) {
+        LOG(ERROR) << "Could not append to snapshot manifest " << manifest_path;
+        return false;
+    }
+    return true;
+}
+
+bool ReconstructSSCLayer(const std::string& manifest_path, size_t step, Layer<SSCOccupancyVoxel>::Ptr* layer_ptr,
+                         size_t num_threads) {
+    CHECK_NOTNULL(layer_ptr);
+    std::vector<SnapshotManifestEntry> entries;
+    if (!LoadSnapshotManifest(manifest_path, &entries)) {
+        return false;
+    }
+    if (step >= entries.size()) {
+        LOG(ERROR) << "Step " << step << " is out of range, " << manifest_path << " lists " << entries.size()
+                   << " snapshots.";
+        return false;
+    }
+
+    size_t base_step = step;
+    while (entries[base_step].is_delta && base_step > 0u) {
+        --base_step;
+    }
+    if (entries[base_step].is_delta) {
+        LOG(ERROR) << "No base snapshot before step " << step << " in " << manifest_path;
+        return false;
+    }
+
+    // deltas replace whole blocks, so applying them in order yields the map at the step
+    const std::string directory = getDirectory(manifest_path);
+    for (size_t i = base_step; i <= step; ++i) {
+        SSCSnapshotReader reader;
+        if (!reader.open(directory + entries[i].file_name)) {
+            return false;
+        }
+        if (i == base_step) {
+            layer_ptr->reset(new Layer<SSCOccupancyVoxel>(reader.voxel_size(), reader.voxels_per_side()));
+        }
+        if (!reader.loadIntoLayer(layer_ptr->get(), num_threads)) {
+            LOG(ERROR) << "Could not apply snapshot " << entries[i].file_name << " of " << manifest_path;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReconstructSSCLayerFromSnapshot(const std::string& snapshot_path, Layer<SSCOccupancyVoxel>::Ptr* layer_ptr,
+                                     size_t num_threads) {
+    const std::string manifest_path = getSnapshotManifestPath(snapshot_path);
+    std::vector<SnapshotManifestEntry> entries;
+    if (!LoadSnapshotManifest(manifest_path, &entries)) {
+        return false;
+    }
+    // the last step wins if a file name was reused
+    const std::string file_name = getFileName(snapshot_path);
+    for (size_t step = entries.size(); step > 0u; --step) {
+        if (entries[step - 1u].file_name == file_name) {
+            return ReconstructSSCLayer(manifest_path, step - 1u, layer_ptr, num_threads);
+        }
+    }
+    LOG(ERROR) << file_name << " is not listed in " << manifest_path;
+    return false;
+}
+
+}  // namespace io
+}  // namespace voxblox
@@ -0,0 +1,104 @@
+#include "ssc_mapping/ros/layer_conversions.h"
+
+#include <atomic>
+#include <cmath>
+
+#include "ssc_mapping/io/snapshot.h"
+#include "ssc_mapping/utils/parallel.h"
+
+namespace voxblox {
+
+bool serializeSSCBlocksAsMsg(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks,
+                             ssc_msgs::SSCLayer* msg, size_t num_threads,
+                             const io::LossyBlockCodecConfig* lossy_config) {
+    CHECK_NOTNULL(msg);
+    msg->encoding = lossy_config ? ssc_msgs::SSCLayer::LOSSY : ssc_msgs::SSCLayer::LOSSLESS;
+    msg->voxel_size = layer.voxel_size();
+    msg->voxels_per_side = static_cast<uint32_t>(layer.voxels_per_side());
+
+    std::vector<Block<SSCOccupancyVoxel>::ConstPtr> allocated_blocks;
+    allocated_blocks.reserve(blocks.size());
+    msg->blocks.clear();
+    msg->blocks.reserve(blocks.size());
+    for (const BlockIndex& block_index : blocks) {
+        Block<SSCOccupancyVoxel>::ConstPtr block = layer.getBlockPtrByIndex(block_index);
+        if (!block) {
+            continue;
+        }
+        ssc_msgs::SSCBlock block_msg;
+        block_msg.x_index = block_index.x();
+        block_msg.y_index = block_index.y();
+        block_msg.z_index = block_index.z();
+        msg->blocks.push_back(block_msg);
+        allocated_blocks.push_back(block);
+    }
+
+    std::atomic<bool> failed(false);
+    parallelForRanges(allocated_blocks.size(), num_threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const bool encoded =
+                lossy_config ? io::encodeSSCBlockLossy(*allocated_blocks[i], *lossy_config, &msg->blocks[i].data,
+                                                       &msg->blocks[i].raw_size)
+                             : io::encodeSSCBlock(*allocated_blocks[i], &msg->blocks[i].data, &msg->blocks[i].raw_size);
+            if (!encoded) {
+                failed = true;
+            }
+        }
+    });
+    return !failed;
+}
+
+bool deserializeMsgToSSCLayer(const ssc_msgs::SSCLayer& msg, Layer<SSCOccupancyVoxel>* layer,
+                              BlockIndexList* updated_blocks, size_t num_threads) {
+    CHECK_NOTNULL(layer);
+    if (std::abs(msg.voxel_size - layer->voxel_size()) > kEpsilon || msg.voxels_per_side != layer->voxels_per_side()) {
+        LOG(ERROR) << "SSC layer update has voxel size " << msg.voxel_size << " and " << msg.voxels_per_side
+                   << " voxels per side, expected " << layer->voxel_size() << " and " << layer->voxels_per_side();
+        return false;
+    }
+
+    // decode into new blocks first so that a broken message leaves the layer untouched
+    std::vector<Block<SSCOccupancyVoxel>::Ptr> blocks(msg.blocks.size());
+    std::atomic<bool> failed(false);
+    parallelForRanges(msg.blocks.size(), num_threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end && !failed; ++i) {
+            const ssc_msgs::SSCBlock& block_msg = msg.blocks[i];
+            const BlockIndex block_index(block_msg.x_index, block_msg.y_index, block_msg.z_index);
+            blocks[i].reset(new Block<SSCOccupancyVoxel>(
+                layer->voxels_per_side(), layer->voxel_size(),
+                getOriginPointFromGridIndex(block_index, layer->block_size())));
+            const bool decoded = msg.encoding == ssc_msgs::SSCLayer::LOSSY
+                                     ? io::decodeSSCBlockLossy(block_msg.data.data(), block_msg.data.size(),
+                                                               block_msg.raw_size, blocks[i].get())
+                                     : io::decodeSSCBlock(block_msg.data.data(), block_msg.data.size(),
+                                                          block_msg.raw_size, blocks[i].get());
+            if (!decoded) {
+                failed = true;
+            }
+        }
+    });
+    if (failed) {
+        LOG(ERROR) << "Could not decode the blocks of an SSC layer update.";
+        return false;
+    }
+
+    if (msg.action == ssc_msgs::SSCLayer::RESET) {
+        layer->removeAllBlocks();
+    }
+    if (updated_blocks) {
+        updated_blocks->clear();
+        updated_blocks->reserve(blocks.size());
+    }
+    for (size_t i = 0u; i < blocks.size(); ++i) {
+        const BlockIndex block_index(msg.blocks[i].x_index, msg.blocks[i].y_index, msg.blocks[i].z_index);
+        blocks[i]->setUpdated(Update::kMap, true);
+        layer->removeBlock(block_index);
+        layer->insertBlock(std::make_pair(block_index, blocks[i]));
+        if (updated_blocks) {
+            updated_blocks->push_back(block_index);
+        }
+    }
+    return true;
+}
+
+}  // namespace voxblox
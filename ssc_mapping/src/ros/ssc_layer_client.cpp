@@ -0,0 +1,114 @@
+#include "ssc_mapping/ros/ssc_layer_client.h"
+
+#include <chrono>
+
+#include <std_srvs/Empty.h>
+
+#include "ssc_mapping/core/staged_blocks.h"
+#include "ssc_mapping/ros/layer_conversions.h"
+
+namespace voxblox {
+
+SSCLayerClient::SSCLayerClient(const ros::NodeHandle& nh, const SSCMap::Config& config,
+                               const std::string& layer_topic, const std::string& resync_service,
+                               const double resync_timeout)
+    : ssc_map_(std::make_shared<SSCMap>(config)), resync_timeout_(resync_timeout), nh_(nh) {
+    std::string service = resync_service;
+    if (service.empty()) {
+        const size_t separator = layer_topic.find_last_of('/');
+        service = (separator == std::string::npos ? std::string() : layer_topic.substr(0u, separator + 1u)) +
+                  "resync_layer";
+    }
+    resync_client_ = nh_.serviceClient<std_srvs::Empty>(service);
+    layer_update_sub_ = nh_.subscribe(layer_topic, 10, &SSCLayerClient::layerUpdateCallback, this);
+    resync_timer_ = nh_.createWallTimer(resync_timeout_, &SSCLayerClient::resyncTimerCallback, this);
+}
+
+SSCLayerClient::~SSCLayerClient() {
+    resync_timer_.stop();
+    layer_update_sub_.shutdown();
+    std::lock_guard<std::mutex> lock(resync_mutex_);
+    if (resync_call_.valid()) {
+        resync_call_.wait();
+    }
+}
+
+bool SSCLayerClient::requestResync() {
+    std_srvs::Empty srv;
+    awaiting_resync_ = true;
+    if (!resync_client_.call(srv)) {
+        LOG(WARNING) << "Could not request an SSC layer resync from " << resync_client_.getService();
+        return false;
+    }
+    return true;
+}
+
+void SSCLayerClient::scheduleResync() {
+    awaiting_resync_ = true;
+    std::lock_guard<std::mutex> lock(resync_mutex_);
+    if (resync_call_.valid() && resync_call_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    const ros::WallTime now = ros::WallTime::now();
+    if (resync_requested_ && now - last_resync_request_ < resync_timeout_) {
+        return;
+    }
+    resync_requested_ = true;
+    last_resync_request_ = now;
+    resync_call_ = std::async(std::launch::async, [this]() { return requestResync(); });
+}
+
+void SSCLayerClient::resyncTimerCallback(const ros::WallTimerEvent& /*event*/) {
+    if (awaiting_resync_) {
+        scheduleResync();
+    }
+}
+
+void SSCLayerClient::layerUpdateCallback(const ssc_msgs::SSCLayer::ConstPtr& msg) {
+    const bool is_reset = msg->action == ssc_msgs::SSCLayer::RESET;
+    if (!is_reset) {
+        if (awaiting_resync_ || msg->base_map_version != server_map_version_) {
+            // missed an update (or joined late), the map can only be recovered by a full resync
+            if (!awaiting_resync_) {
+                LOG(WARNING) << "Missed SSC layer updates between map versions " << server_map_version_ << " and "
+                             << msg->base_map_version << ", requesting a resync.";
+            }
+            scheduleResync();
+            return;
+        }
+    }
+
+    // decode and summarize the blocks before readers of the map have to wait
+    const Layer<SSCOccupancyVoxel>& layer = ssc_map_->getSSCLayer();
+    Layer<SSCOccupancyVoxel> received_layer(layer.voxel_size(), layer.voxels_per_side());
+    BlockIndexList updated_blocks;
+    if (!deserializeMsgToSSCLayer(*msg, &received_layer, &updated_blocks)) {
+        scheduleResync();
+        return;
+    }
+    SSCStagedBlocks staged_blocks(ssc_map_.get());
+    for (const BlockIndex& block_index : updated_blocks) {
+        staged_blocks.insertBlock(block_index, received_layer.getBlockPtrByIndex(block_index));
+    }
+    {
+        SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+        if (is_reset) {
+            ssc_map_->clear();
+        }
+        staged_blocks.apply();
+    }
+
+    if (is_reset) {
+        change_tracker_.markReset();
+    }
+    for (const BlockIndex& block_index : updated_blocks) {
+        change_tracker_.markBlock(block_index);
+    }
+    change_tracker_.commit();
+    server_map_version_ = msg->map_version;
+    awaiting_resync_ = false;
+    std::lock_guard<std::mutex> lock(resync_mutex_);
+    resync_requested_ = false;
+}
+
+}  // namespace voxblox
@@ -1,14 +1,25 @@
 #include "ssc_mapping/ros/ssc_server.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
 #include <voxblox/core/common.h>
 #include <voxblox/core/voxel.h>
 
+#include "ssc_mapping/core/staged_blocks.h"
 #include "ssc_mapping/core/voxel.h"
 #include "ssc_mapping/fusion/naive_fusion.h"
 #include "ssc_mapping/fusion/log_odds_fusion.h"
 #include "ssc_mapping/fusion/occupancy_fusion.h"
 #include "ssc_mapping/fusion/counting_fusion.h"
 #include "ssc_mapping/fusion/sc_fusion.h"
+#include "ssc_mapping/io/layer_io.h"
+#include "ssc_mapping/io/snapshot.h"
+#include "ssc_mapping/io/snapshot_manifest.h"
+#include "ssc_mapping/ros/layer_conversions.h"
+#include "ssc_mapping/utils/block_index_math.h"
 #include "ssc_mapping/utils/voxel_utils.h"
 #include "ssc_mapping/visualization/visualization.h"
 
@@ -33,11 +44,68 @@ SSCServer::SSCServer(const ros::NodeHandle& nh, const ros::NodeHandle& nh_privat
         base_fusion_.reset(new ssc_fusion::OccupancyFusion(fusion_config));
     }
 
+    // select the integration loop specialized for the block size once
+    integrate_grid_fn_ = dispatchBlockIndexMath(
+        config.ssc_voxels_per_side,
+        [this](const auto& math) -> std::function<void(const ssc_msgs::SSCGrid&, SSCStagedBlocks*)> {
+            return [this, math](const ssc_msgs::SSCGrid& msg, SSCStagedBlocks* staged_blocks) {
+                integrateGrid(msg, math, staged_blocks);
+            };
+        });
+
     // subscribe to SSC from node with 3D CNN 
     nh_private_.param("ssc_topic", ssc_topic_, ssc_topic_);
     ssc_map_sub_ = nh_.subscribe(ssc_topic_, 50, &SSCServer::sscCallback, this);
 
     nh_private_.param("publish_pointclouds", publish_pointclouds_on_update_, publish_pointclouds_on_update_);
+    nh_private_.param("visualization_period", visualization_period_, visualization_period_);
+    nh_private_.param("per_block_markers", per_block_markers_, per_block_markers_);
+
+    // record which voxels of a block changed, not only the blocks
+    bool track_voxel_changes = false;
+    nh_private_.param("track_voxel_changes", track_voxel_changes, track_voxel_changes);
+    change_tracker_.setTrackVoxels(track_voxel_changes);
+
+    // write through all integrated blocks to a memory mapped block store
+    bool block_store_resume = false;
+    nh_private_.param("block_store_path", block_store_path_, block_store_path_);
+    nh_private_.param("block_store_resume", block_store_resume, block_store_resume);
+    if (!block_store_path_.empty()) {
+        block_store_.reset(new io::SSCBlockStore());
+        if (!block_store_->open(block_store_path_, io::SSCBlockStore::Mode::kReadWrite, config.ssc_voxel_size,
+                                config.ssc_voxels_per_side, !block_store_resume)) {
+            LOG(ERROR) << "Could not open block store " << block_store_path_ << ". Blocks are not persisted.";
+            block_store_.reset();
+        } else if (block_store_resume) {
+            SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+            block_store_->loadIntoLayer(ssc_map_->getSSCLayerPtr());
+            ssc_map_->recomputeBlockSummaries();
+            LOG(INFO) << "Resumed " << block_store_->getNumberOfStoredBlocks() << " blocks from "
+                      << block_store_path_;
+        }
+    }
+    if (block_store_) {
+        addChangeListener([this](const SSCChangeSet& change_set) {
+            block_store_->writeBlocks(ssc_map_->getSSCLayer(), change_set.blocks);
+        });
+    }
+
+    // blocks to rebuild in the visualization cache
+    addChangeListener([this](const SSCChangeSet& change_set) {
+        if (change_set.map_reset) {
+            visualization_reset_ = true;
+            visualization_blocks_.clear();
+        }
+        visualization_blocks_.insert(change_set.blocks.begin(), change_set.blocks.end());
+        if (!publish_mesh_) {
+            return;
+        }
+        if (change_set.map_reset) {
+            mesh_reset_ = true;
+            mesh_blocks_.clear();
+        }
+        mesh_blocks_.insert(change_set.blocks.begin(), change_set.blocks.end());
+    });
 
     save_map_srv_ = nh_private_.advertiseService(
       "save_map", &SSCServer::saveMapCallback, this);
@@ -47,8 +115,95 @@ SSCServer::SSCServer(const ros::NodeHandle& nh, const ros::NodeHandle& nh_privat
         ssc_pointcloud_pub_ =
             nh_private_.advertise<pcl::PointCloud<pcl::PointXYZRGB> >("occupancy_pointcloud", 1, true);
 
-        // publish fused maps as occupancy nodes - marker array
-        occupancy_marker_pub_ = nh_private_.advertise<visualization_msgs::MarkerArray>("ssc_occupied_nodes", 1, true);
+        // publish fused maps as occupancy nodes - marker array. Incremental per block
+        // markers are not latched, new subscribers get all blocks instead
+        occupancy_marker_pub_ = nh_private_.advertise<visualization_msgs::MarkerArray>(
+            "ssc_occupied_nodes", per_block_markers_ ? 10 : 1, !per_block_markers_);
+
+        // level of detail pyramid of the occupied voxels, lod_levels coarse levels
+        // above the map resolution, 0 disables it
+        SSCLodPyramid::Config lod_config;
+        lod_config.num_levels = 0;
+        nh_private_.param("lod_levels", lod_config.num_levels, lod_config.num_levels);
+        nh_private_.param("lod_level_distance", lod_config.level_distance, lod_config.level_distance);
+        nh_private_.param("lod_fixed_level", lod_config.fixed_level, lod_config.fixed_level);
+        if (lod_config.num_levels > 0) {
+            lod_pyramid_.reset(new SSCLodPyramid(ssc_map_->voxel_size(),
+                                                 ssc_map_->getSSCLayer().voxels_per_side(), lod_config));
+            lod_marker_pub_ =
+                nh_private_.advertise<visualization_msgs::MarkerArray>("ssc_occupied_nodes_lod", 1, true);
+        }
+    }
+
+    // semantic surface mesh of the occupied voxels
+    nh_private_.param("publish_mesh", publish_mesh_, publish_mesh_);
+    if (publish_mesh_) {
+        mesh_layer_.reset(new MeshLayer(ssc_map_->block_size()));
+        mesh_integrator_.reset(new SSCMeshIntegrator(*ssc_map_, mesh_layer_.get()));
+        mesh_pub_ = nh_private_.advertise<voxblox_msgs::Mesh>("mesh", 1, true);
+    }
+
+    // publish at a fixed rate instead of after every integration, a period <= 0 restores the latter
+    if ((publish_pointclouds_on_update_ || publish_mesh_) && visualization_period_ > 0.0) {
+        visualization_timer_ = nh_private_.createTimer(ros::Duration(visualization_period_),
+                                                       &SSCServer::publishVisualizationEvent, this);
+    }
+
+    // incremental block updates for processes mirroring the map instead of fusing the grids again
+    nh_private_.param("publish_layer_updates", publish_layer_updates_, publish_layer_updates_);
+    nh_private_.param("layer_update_period", layer_update_period_, layer_update_period_);
+    if (publish_layer_updates_) {
+        layer_update_pub_ = nh_private_.advertise<ssc_msgs::SSCLayer>("ssc_layer_updates", 10, false);
+        addChangeListener([this](const SSCChangeSet& change_set) {
+            if (change_set.map_reset) {
+                layer_update_reset_ = true;
+                layer_update_blocks_.clear();
+            }
+            layer_update_blocks_.insert(change_set.blocks.begin(), change_set.blocks.end());
+        });
+        if (layer_update_period_ > 0.0) {
+            layer_update_timer_ = nh_private_.createTimer(ros::Duration(layer_update_period_),
+                                                          &SSCServer::publishLayerUpdateEvent, this);
+        }
+    }
+
+    // lossy map stream, e.g. to a ground station over wifi
+    double stream_log_odds_step = stream_codec_config_.log_odds_step;
+    double stream_confident_log_odds = stream_codec_config_.confident_log_odds;
+    nh_private_.param("stream_map", stream_map_, stream_map_);
+    nh_private_.param("stream_period", stream_period_, stream_period_);
+    nh_private_.param("stream_max_bytes_per_second", stream_max_bytes_per_second_, stream_max_bytes_per_second_);
+    nh_private_.param("stream_nearest_first", stream_nearest_first_, stream_nearest_first_);
+    nh_private_.param("stream_log_odds_step", stream_log_odds_step, stream_log_odds_step);
+    nh_private_.param("stream_confident_log_odds", stream_confident_log_odds, stream_confident_log_odds);
+    stream_codec_config_.log_odds_step = static_cast<float>(stream_log_odds_step);
+    stream_codec_config_.confident_log_odds = static_cast<float>(stream_confident_log_odds);
+    if (stream_map_) {
+        map_stream_pub_ = nh_private_.advertise<ssc_msgs::SSCLayer>("ssc_map_stream", 10, false);
+        addChangeListener([this](const SSCChangeSet& change_set) {
+            if (change_set.map_reset) {
+                stream_reset_ = true;
+                stream_blocks_.clear();
+            }
+            stream_blocks_.insert(change_set.blocks.begin(), change_set.blocks.end());
+        });
+        map_stream_timer_ =
+            nh_private_.createTimer(ros::Duration(stream_period_), &SSCServer::publishMapStreamEvent, this);
+    }
+    if (publish_layer_updates_ || stream_map_) {
+        resync_layer_srv_ = nh_private_.advertiseService("resync_layer", &SSCServer::resyncLayerCallback, this);
+    }
+
+    // warm start from a map of an earlier mission
+    std::string load_map_path;
+    nh_private_.param("io_threads", io_threads_, io_threads_);
+    nh_private_.param("delta_snapshots", delta_snapshots_, delta_snapshots_);
+    nh_private_.param("async_save_map", async_save_map_, async_save_map_);
+    nh_private_.param("save_map_blocking", save_map_blocking_, save_map_blocking_);
+    nh_private_.param("load_map_path", load_map_path, load_map_path);
+    load_map_srv_ = nh_private_.advertiseService("load_map", &SSCServer::loadMapCallback, this);
+    if (!load_map_path.empty()) {
+        loadMap(load_map_path);
     }
 }
 
@@ -84,22 +239,276 @@ SSCMap::Config SSCServer::getSSCMapConfigFromRosParam(const ros::NodeHandle& nh_
     return ssc_map_config;
 }
 
+void SSCServer::clear() {
+    {
+        SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+        ssc_map_->clear();
+    }
+    if (block_store_) {
+        // discard persisted blocks as well
+        block_store_->open(block_store_path_, io::SSCBlockStore::Mode::kReadWrite, ssc_map_->voxel_size(),
+                           ssc_map_->getSSCLayer().voxels_per_side(), true);
+    }
+    change_tracker_.markReset();
+    change_tracker_.commit();
+    snapshot_base_pending_ = true;
+}
+
 bool SSCServer::saveMap(const std::string& file_path) {
   // Inheriting classes should add saving other layers to this function.
-  return io::SaveLayer(ssc_map_->getSSCLayer(), file_path);
+  const size_t num_threads = static_cast<size_t>(std::max(0, io_threads_));
+  const Layer<SSCOccupancyVoxel>& ssc_layer = ssc_map_->getSSCLayer();
+  BlockIndexList blocks;
+  io::SSCAsyncSnapshotWriter::WriteFunction write_fn;
+
+  if (!io::hasExtension(file_path, io::kSnapshotExtension)) {
+    ssc_layer.getAllAllocatedBlocks(&blocks);
+    write_fn = [file_path](const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList&) {
+      return io::SaveLayer(layer, file_path);
+    };
+  } else if (!delta_snapshots_) {
+    ssc_layer.getAllAllocatedBlocks(&blocks);
+    write_fn = [file_path, num_threads](const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks) {
+      return io::SaveSSCSnapshot(layer, blocks, file_path, num_threads);
+    };
+  } else {
+    // a failed previous write falls back to a base snapshot, so it has to be
+    // finished before deciding what this one contains
+    snapshot_writer_.wait();
+    const std::string manifest_path = io::getSnapshotManifestPath(file_path);
+    io::SnapshotManifestEntry entry;
+    entry.file_name = io::getFileName(file_path);
+    entry.map_version = change_tracker_.getMapVersion();
+    entry.is_delta = !snapshot_base_pending_ && manifest_path == snapshot_manifest_path_;
+    if (entry.is_delta) {
+      change_tracker_.getBlocksModifiedSince(last_snapshot_version_, &blocks);
+    } else {
+      ssc_layer.getAllAllocatedBlocks(&blocks);
+    }
+    snapshot_base_pending_ = false;
+    last_snapshot_version_ = entry.map_version;
+    snapshot_manifest_path_ = manifest_path;
+
+    write_fn = [this, file_path, num_threads, manifest_path, entry](const Layer<SSCOccupancyVoxel>& layer,
+                                                                   const BlockIndexList& blocks) {
+      if (!io::SaveSSCSnapshot(layer, blocks, file_path, num_threads, entry.is_delta) ||
+          !io::AppendSnapshotManifestEntry(manifest_path, entry)) {
+        // later deltas would miss these blocks
+        snapshot_base_pending_ = true;
+        return false;
+      }
+      LOG(INFO) << "Saved " << (entry.is_delta ? "delta" : "base") << " snapshot of " << blocks.size()
+                << " blocks to " << file_path;
+      return true;
+    };
+  }
+
+  if (!async_save_map_) {
+    return write_fn(ssc_layer, blocks);
+  }
+  snapshot_writer_.start(ssc_layer, blocks, write_fn);
+  return save_map_blocking_ ? snapshot_writer_.wait() : true;
 }
 
-bool SSCServer::saveMapCallback(voxblox_msgs::FilePath::Request& request,
-                                 voxblox_msgs::FilePath::Response& ) { 
-  return saveMap(request.file_path);
+bool SSCServer::loadMap(const std::string& file_path) {
+    auto t_start = std::chrono::high_resolution_clock::now();
+    Layer<SSCOccupancyVoxel>::Ptr loaded_layer;
+    if (!io::LoadSSCLayer(file_path, &loaded_layer, static_cast<size_t>(std::max(0, io_threads_)))) {
+        LOG(ERROR) << "Could not load map from " << file_path;
+        return false;
+    }
+
+    const Layer<SSCOccupancyVoxel>* ssc_layer = ssc_map_->getSSCLayerConstPtr();
+    if (std::abs(loaded_layer->voxel_size() - ssc_layer->voxel_size()) > kEpsilon ||
+        loaded_layer->voxels_per_side() != ssc_layer->voxels_per_side()) {
+        LOG(ERROR) << "Map in " << file_path << " has voxel size " << loaded_layer->voxel_size() << " and "
+                   << loaded_layer->voxels_per_side() << " voxels per side, expected " << ssc_layer->voxel_size()
+                   << " and " << ssc_layer->voxels_per_side();
+        return false;
+    }
+
+    // loaded blocks replace the blocks of the map, the blocks are moved, not copied
+    BlockIndexList blocks;
+    loaded_layer->getAllAllocatedBlocks(&blocks);
+    SSCStagedBlocks staged_blocks(ssc_map_.get());
+    for (const BlockIndex& block_idx : blocks) {
+        Block<SSCOccupancyVoxel>::Ptr block = loaded_layer->getBlockPtrByIndex(block_idx);
+        block->setUpdated(Update::kMap, true);
+        staged_blocks.insertBlock(block_idx, block);
+        change_tracker_.markBlock(block_idx);
+    }
+    {
+        SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+        staged_blocks.apply();
+    }
+    change_tracker_.commit();
+
+    auto t_end = std::chrono::high_resolution_clock::now();
+    LOG(INFO) << "Loaded " << blocks.size() << " blocks from " << file_path << " in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t_end - t_start).count() << " ms";
+
+    if ((publish_pointclouds_on_update_ || publish_mesh_) && visualization_period_ <= 0.0) {
+        publishVisualization();
+    }
+    return true;
 }
 
-void SSCServer::sscCallback(const ssc_msgs::SSCGrid::ConstPtr& msg) {
-    if (msg->origin_z < -1.5f) {  // a check to print if there is a wrong pose/outlier received
-        LOG(WARNING) << "Outlier pose detected with origin at " << msg->origin_z << ". Skipping..";
+void SSCServer::publishLayerUpdate() {
+    // late subscribers request a resync anyway
+    if (layer_update_pub_.getNumSubscribers() == 0u) {
+        return;
+    }
+    if (layer_update_reset_) {
+        // clients have to drop their blocks, a full layer does that
+        publishFullLayer();
+        return;
+    }
+    if (layer_update_blocks_.empty()) {
         return;
     }
 
+    ssc_msgs::SSCLayer msg;
+    msg.header.frame_id = world_frame_;
+    msg.header.stamp = ros::Time::now();
+    msg.action = ssc_msgs::SSCLayer::UPDATE;
+    msg.base_map_version = published_map_version_;
+    msg.map_version = getMapVersion();
+    const BlockIndexList blocks(layer_update_blocks_.begin(), layer_update_blocks_.end());
+    if (!serializeSSCBlocksAsMsg(ssc_map_->getSSCLayer(), blocks, &msg, static_cast<size_t>(std::max(0, io_threads_)))) {
+        LOG(ERROR) << "Could not serialize the SSC layer update, publishing the full layer next time.";
+        layer_update_reset_ = true;
+        return;
+    }
+    layer_update_pub_.publish(msg);
+    layer_update_blocks_.clear();
+    published_map_version_ = msg.map_version;
+}
+
+void SSCServer::publishFullLayer() {
+    ssc_msgs::SSCLayer msg;
+    msg.header.frame_id = world_frame_;
+    msg.header.stamp = ros::Time::now();
+    msg.action = ssc_msgs::SSCLayer::RESET;
+    msg.base_map_version = published_map_version_;
+    msg.map_version = getMapVersion();
+    BlockIndexList blocks;
+    ssc_map_->getSSCLayer().getAllAllocatedBlocks(&blocks);
+    if (!serializeSSCBlocksAsMsg(ssc_map_->getSSCLayer(), blocks, &msg, static_cast<size_t>(std::max(0, io_threads_)))) {
+        LOG(ERROR) << "Could not serialize the SSC layer.";
+        return;
+    }
+    layer_update_pub_.publish(msg);
+    layer_update_blocks_.clear();
+    layer_update_reset_ = false;
+    published_map_version_ = msg.map_version;
+}
+
+bool SSCServer::resyncLayerCallback(std_srvs::Empty::Request& /*request*/,
+                                    std_srvs::Empty::Response& /*response*/) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    if (publish_layer_updates_) {
+        publishFullLayer();
+    }
+    if (stream_map_) {
+        // stream all blocks again, starting with a RESET
+        BlockIndexList blocks;
+        ssc_map_->getSSCLayer().getAllAllocatedBlocks(&blocks);
+        stream_blocks_.insert(blocks.begin(), blocks.end());
+        stream_reset_ = true;
+    }
+    return publish_layer_updates_ || stream_map_;
+}
+
+void SSCServer::publishMapStream() {
+    if (map_stream_pub_.getNumSubscribers() == 0u || (stream_blocks_.empty() && !stream_reset_)) {
+        return;
+    }
+
+    const Layer<SSCOccupancyVoxel>& ssc_layer = ssc_map_->getSSCLayer();
+    BlockIndexList blocks;
+    blocks.reserve(stream_blocks_.size());
+    for (auto it = stream_blocks_.begin(); it != stream_blocks_.end();) {
+        // blocks removed from the map since, nothing to send for them
+        if (!ssc_layer.getBlockPtrByIndex(*it)) {
+            it = stream_blocks_.erase(it);
+            continue;
+        }
+        blocks.push_back(*it);
+        ++it;
+    }
+    if (stream_nearest_first_) {
+        const FloatingPoint block_size = ssc_layer.block_size();
+        const Point half_block = Point::Constant(0.5f * block_size);
+        auto distance = [&](const BlockIndex& block_idx) {
+            return (getOriginPointFromGridIndex(block_idx, block_size) + half_block - last_grid_center_).squaredNorm();
+        };
+        std::sort(blocks.begin(), blocks.end(),
+                  [&](const BlockIndex& a, const BlockIndex& b) { return distance(a) < distance(b); });
+    }
+
+    ssc_msgs::SSCLayer msg;
+    msg.header.frame_id = world_frame_;
+    msg.header.stamp = ros::Time::now();
+    msg.action = stream_reset_ ? ssc_msgs::SSCLayer::RESET : ssc_msgs::SSCLayer::UPDATE;
+    msg.encoding = ssc_msgs::SSCLayer::LOSSY;
+    msg.voxel_size = ssc_layer.voxel_size();
+    msg.voxels_per_side = static_cast<uint32_t>(ssc_layer.voxels_per_side());
+    msg.base_map_version = streamed_map_version_;
+    msg.map_version = getMapVersion();
+
+    // encode in batches in priority order until the budget of this period is used up,
+    // at least one block is sent so that the stream always makes progress
+    constexpr size_t kBatchSize = 64u;
+    const size_t budget = stream_max_bytes_per_second_ > 0.0
+                              ? static_cast<size_t>(stream_max_bytes_per_second_ * stream_period_)
+                              : std::numeric_limits<size_t>::max();
+    const size_t num_threads = static_cast<size_t>(std::max(0, io_threads_));
+    size_t num_bytes = 0u;
+    size_t num_sent = 0u;
+    bool budget_reached = false;
+    for (size_t begin = 0u; begin < blocks.size() && !budget_reached; begin += kBatchSize) {
+        const BlockIndexList batch(blocks.begin() + begin, blocks.begin() + std::min(blocks.size(), begin + kBatchSize));
+        ssc_msgs::SSCLayer batch_msg;
+        if (!serializeSSCBlocksAsMsg(ssc_layer, batch, &batch_msg, num_threads, &stream_codec_config_)) {
+            LOG(ERROR) << "Could not encode the blocks of the map stream.";
+            return;
+        }
+        for (ssc_msgs::SSCBlock& block_msg : batch_msg.blocks) {
+            const size_t block_bytes = block_msg.data.size() + sizeof(ssc_msgs::SSCBlock);
+            if (num_sent > 0u && num_bytes + block_bytes > budget) {
+                budget_reached = true;
+                break;
+            }
+            num_bytes += block_bytes;
+            msg.blocks.push_back(std::move(block_msg));
+            ++num_sent;
+        }
+    }
+
+    map_stream_pub_.publish(msg);
+    stream_reset_ = false;
+    streamed_map_version_ = msg.map_version;
+    for (size_t i = 0u; i < num_sent; ++i) {
+        stream_blocks_.erase(blocks[i]);
+    }
+    VLOG(1) << "Streamed " << num_sent << " blocks in " << num_bytes << " bytes, " << stream_blocks_.size()
+            << " blocks pending.";
+}
+
+bool SSCServer::loadMapCallback(voxblox_msgs::FilePath::Request& request,
+                                voxblox_msgs::FilePath::Response& ) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    return loadMap(request.file_path);
+}
+
+bool SSCServer::saveMapCallback(voxblox_msgs::FilePath::Request& request,
+                                 voxblox_msgs::FilePath::Response& ) { 
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  return saveMap(request.file_path);
+}
+
+template <typename IndexMath>
+void SSCServer::integrateGrid(const ssc_msgs::SSCGrid& msg, const IndexMath& math, SSCStagedBlocks* staged_blocks) {
     auto exp_decay_weight = [](double x, double y, double z, double std_dev) {
         return exp(-0.5 * (1.0 / std_dev) * sqrt((x * x) + (y * y) + (z * z)));
     };
@@ -137,12 +546,20 @@ void SSCServer::sscCallback(const ssc_msgs::SSCGrid::ConstPtr& msg) {
     // as numpy saved
     // Or  convert Y,Z,X -> X,Y,Z before sending and send transpose
     // of X,Y,Z from Numpy and load here with the x being fastest axis.
-    for (size_t x = 0; x < msg->depth; x++) {
-        for (size_t y = 0; y < msg->height; y++) {
-            for (size_t z = 0; z < msg->width; z++) {
-                size_t idx = x * msg->width * msg->height + y * msg->width + z;
-                uint predicted_label = msg->data[idx];
-                float free_space_confidence = msg->data[idx] - predicted_label;
+    const auto grid_origin_index = getGridIndexFromOriginPoint<GlobalIndex>(
+        Point(msg.origin_x, msg.origin_y, msg.origin_z), ssc_map_->getSSCLayer().voxel_size_inv());
+
+    // consecutive voxels mostly fall into the same block, cache it
+    Block<SSCOccupancyVoxel>::Ptr block;
+    SSCBlockSummary* block_summary = nullptr;
+    BlockIndex block_idx;
+
+    for (size_t x = 0; x < msg.depth; x++) {
+        for (size_t y = 0; y < msg.height; y++) {
+            for (size_t z = 0; z < msg.width; z++) {
+                size_t idx = x * msg.width * msg.height + y * msg.width + z;
+                uint predicted_label = msg.data[idx];
+                float free_space_confidence = msg.data[idx] - predicted_label;
                 float occupied_confidence = 1 - free_space_confidence;
 
                 float weight = decay_weight_std_ > 0 ? exp_decay_weight(x, y, z, decay_weight_std_) : 1;
@@ -152,59 +569,199 @@ void SSCServer::sscCallback(const ssc_msgs::SSCGrid::ConstPtr& msg) {
                 uint32_t world_orient_y = x;
                 uint32_t world_orient_z = y;
 
-                auto grid_origin_index = getGridIndexFromOriginPoint<GlobalIndex>(
-                    Point(msg->origin_x, msg->origin_y, msg->origin_z), ssc_map_->getSSCLayerPtr()->voxel_size_inv());
-
                 GlobalIndex voxelIdx(world_orient_x, world_orient_y, world_orient_z);
 
                 // add origin so that new voxels are integrated wrt origin
                 voxelIdx += grid_origin_index;
 
-                SSCOccupancyVoxel* voxel = ssc_map_->getSSCLayerPtr()->getVoxelPtrByGlobalIndex(voxelIdx);
-
-                // check if the block containing the voxel exists.
-                if (voxel == nullptr) {
-                    // ssc_map_->getSSCLayerPtr()->a
-                    BlockIndex block_idx =
-                        getBlockIndexFromGlobalVoxelIndex(voxelIdx, ssc_map_->getSSCLayerPtr()->voxels_per_side_inv());
-                    auto block = ssc_map_->getSSCLayerPtr()->allocateBlockPtrByIndex(block_idx);
-                    const VoxelIndex local_voxel_idx =
-                        getLocalFromGlobalVoxelIndex(voxelIdx, ssc_map_->getSSCLayerPtr()->voxels_per_side());
-                    voxel = &block->getVoxelByVoxelIndex(local_voxel_idx);
+                const BlockIndex voxel_block_idx = math.computeBlockIndex(voxelIdx);
+                const size_t linear_voxel_idx = math.computeLinearIndex(voxelIdx);
+
+                // fuse into a staged copy of the block, readers keep the current one.
+                // A copy also leaves the block untouched for a running snapshot write.
+                if (!block || voxel_block_idx != block_idx) {
+                    block_idx = voxel_block_idx;
+                    block = staged_blocks->getBlock(block_idx, &block_summary);
+                    block->set_has_data(true);
+                    block->setUpdated(Update::kMap, true);
+                    change_tracker_.markBlock(block_idx);
+                }
+                SSCOccupancyVoxel* voxel = &block->getVoxelByLinearIndex(linear_voxel_idx);
+
+                if (change_tracker_.isTrackingVoxels()) {
+                    const SSCOccupancyVoxel previous_voxel = *voxel;
+                    base_fusion_->fuseWithSummary(voxel, block_summary, predicted_label, occupied_confidence, weight);
+                    if (previous_voxel.observed != voxel->observed || previous_voxel.label != voxel->label ||
+                        previous_voxel.probability_log != voxel->probability_log ||
+                        previous_voxel.label_weight != voxel->label_weight) {
+                        change_tracker_.markVoxel(block_idx, linear_voxel_idx, math.num_voxels());
+                    }
+                } else {
+                    base_fusion_->fuseWithSummary(voxel, block_summary, predicted_label, occupied_confidence, weight);
                 }
-
-                base_fusion_->fuse(voxel, predicted_label, occupied_confidence, weight);
             }
         }
     }
+}
+
+void SSCServer::sscCallback(const ssc_msgs::SSCGrid::ConstPtr& msg) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    if (msg->origin_z < -1.5f) {  // a check to print if there is a wrong pose/outlier received
+        LOG(WARNING) << "Outlier pose detected with origin at " << msg->origin_z << ". Skipping..";
+        return;
+    }
+
+    // the grid is centered on the vehicle, which prioritizes the map stream
+    const FloatingPoint voxel_size = ssc_map_->voxel_size();
+    last_grid_center_ = Point(msg->origin_x, msg->origin_y, msg->origin_z) +
+                        0.5f * voxel_size * Point(msg->width, msg->depth, msg->height);
+
+    SSCStagedBlocks staged_blocks(ssc_map_.get());
+    integrate_grid_fn_(*msg, &staged_blocks);
 
     // merge the layer into the map. Used to upsample the predictions
     // note - upsampling slow so using larger voxel size than to upsample
     // to match orignal voxel size
     // mergeLayerAintoLayerB(temp_layer, ssc_map_->getSSCLayerPtr());
 
-    if (publish_pointclouds_on_update_) {
-        publishSSCOccupancyPoints();
-        publishSSCOccupiedNodes();
+    // readers only wait for the fused blocks to be swapped in
+    {
+        SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+        staged_blocks.apply();
+    }
+
+    // hand the modified blocks to the listeners
+    change_tracker_.commit();
+
+    if ((publish_pointclouds_on_update_ || publish_mesh_) && visualization_period_ <= 0.0) {
+        publishVisualization();
     }
 }
 
+void SSCServer::updateVisualizationCache() {
+    if (visualization_reset_) {
+        visualization_cache_.clear();
+        if (lod_pyramid_) {
+            lod_pyramid_->clear();
+        }
+        visualization_reset_ = false;
+    }
+    if (visualization_blocks_.empty()) {
+        return;
+    }
+    const BlockIndexList blocks(visualization_blocks_.begin(), visualization_blocks_.end());
+    visualization_cache_.updateBlocks(*ssc_map_, blocks);
+    if (lod_pyramid_) {
+        lod_pyramid_->updateBlocks(ssc_map_->getSSCLayer(), blocks);
+    }
+    visualization_blocks_.clear();
+}
+
 void SSCServer::publishSSCOccupancyPoints() {
-    // Create a pointcloud with distance = intensity.
+    updateVisualizationCache();
     pcl::PointCloud<pcl::PointXYZRGB> pointcloud;
-    createPointcloudFromSSCLayer(ssc_map_->getSSCLayer(), &pointcloud);
+    visualization_cache_.createPointcloud(&pointcloud);
 
     pointcloud.header.frame_id = world_frame_;
     ssc_pointcloud_pub_.publish(pointcloud);
 }
 
 void SSCServer::publishSSCOccupiedNodes() {
-    // Create a pointcloud with distance = intensity.
+    updateVisualizationCache();
     visualization_msgs::MarkerArray marker_array;
-    createOccupancyBlocksFromSSCLayer(ssc_map_->getSSCLayer(), world_frame_, &marker_array);
+    if (per_block_markers_) {
+        // resend all blocks when someone subscribed since the last update
+        const size_t num_subscribers = occupancy_marker_pub_.getNumSubscribers();
+        visualization_cache_.createOccupiedNodeUpdates(ssc_map_->voxel_size(), world_frame_,
+                                                       num_subscribers > marker_subscribers_, &marker_array);
+        marker_subscribers_ = num_subscribers;
+        if (marker_array.markers.empty()) {
+            return;
+        }
+    } else {
+        visualization_cache_.createOccupiedNodes(ssc_map_->voxel_size(), world_frame_, &marker_array);
+    }
     occupancy_marker_pub_.publish(marker_array);
 }
 
+void SSCServer::publishSSCOccupiedNodesLod() {
+    updateVisualizationCache();
+    visualization_msgs::MarkerArray marker_array;
+    lod_pyramid_->createOccupiedNodes(visualization_cache_, last_grid_center_, world_frame_, &marker_array);
+    lod_marker_pub_.publish(marker_array);
+    lod_center_ = last_grid_center_;
+}
+
+void SSCServer::publishVisualization() {
+    // latched messages stay valid until the map changes
+    if (!visualization_blocks_.empty() || visualization_reset_) {
+        pointcloud_outdated_ = true;
+        occupied_nodes_outdated_ = true;
+        lod_outdated_ = true;
+    }
+    if (pointcloud_outdated_ && ssc_pointcloud_pub_.getNumSubscribers() > 0u) {
+        publishSSCOccupancyPoints();
+        pointcloud_outdated_ = false;
+    }
+    const size_t num_marker_subscribers = occupancy_marker_pub_.getNumSubscribers();
+    if (num_marker_subscribers > 0u &&
+        (occupied_nodes_outdated_ || (per_block_markers_ && num_marker_subscribers > marker_subscribers_))) {
+        publishSSCOccupiedNodes();
+        occupied_nodes_outdated_ = false;
+    }
+    marker_subscribers_ = num_marker_subscribers;
+
+    if (lod_pyramid_) {
+        // levels selected by distance change as the vehicle moves
+        const SSCLodPyramid::Config& lod_config = lod_pyramid_->getConfig();
+        if (lod_config.fixed_level < 0 &&
+            (last_grid_center_ - lod_center_).norm() > 0.5 * lod_config.level_distance) {
+            lod_outdated_ = true;
+        }
+        if (lod_outdated_ && lod_marker_pub_.getNumSubscribers() > 0u) {
+            publishSSCOccupiedNodesLod();
+            lod_outdated_ = false;
+        }
+    }
+
+    if (publish_mesh_) {
+        publishMesh();
+    }
+}
+
+void SSCServer::publishMesh() {
+    const size_t num_subscribers = mesh_pub_.getNumSubscribers();
+    const bool new_subscribers = num_subscribers > mesh_subscribers_;
+    mesh_subscribers_ = num_subscribers;
+    if (num_subscribers == 0u || (mesh_blocks_.empty() && !mesh_reset_ && !new_subscribers)) {
+        return;
+    }
+
+    if (mesh_reset_) {
+        // the emptied meshes are sent once to clear them on the receiver side
+        mesh_integrator_->clearMesh();
+        mesh_reset_ = false;
+    }
+    const BlockIndexList blocks(mesh_blocks_.begin(), mesh_blocks_.end());
+    mesh_integrator_->generateMesh(blocks);
+    mesh_blocks_.clear();
+
+    if (new_subscribers) {
+        // only updated meshes are sent, resend all of them
+        BlockIndexList mesh_blocks;
+        mesh_layer_->getAllAllocatedMeshes(&mesh_blocks);
+        for (const BlockIndex& block_index : mesh_blocks) {
+            mesh_layer_->getMeshPtrByIndex(block_index)->updated = true;
+        }
+    }
+
+    voxblox_msgs::Mesh mesh_msg;
+    generateVoxbloxMeshMsg(mesh_layer_, ColorMode::kColor, &mesh_msg);
+    mesh_msg.header.frame_id = world_frame_;
+    mesh_msg.header.stamp = ros::Time::now();
+    mesh_pub_.publish(mesh_msg);
+}
+
 // function definitions
 std::string SSCMap::Config::print() const {
     std::stringstream ss;
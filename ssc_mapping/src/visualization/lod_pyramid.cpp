@@ -0,0 +1,193 @@
+#include "ssc_mapping/visualization/lod_pyramid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ssc_mapping/utils/voxel_utils.h"
+
+namespace voxblox {
+
+namespace {
+
+// index of the block of the next coarser level, rounding towards negative infinity
+inline BlockIndex getParentBlockIndex(const BlockIndex& block_index, int num_levels_up = 1) {
+    return BlockIndex(block_index.x() >> num_levels_up, block_index.y() >> num_levels_up,
+                      block_index.z() >> num_levels_up);
+}
+
+}  // namespace
+
+SSCLodPyramid::SSCLodPyramid(FloatingPoint voxel_size, size_t voxels_per_side, const Config& config)
+    : config_(config), voxel_size_(voxel_size), voxels_per_side_(voxels_per_side) {
+    CHECK_GE(config_.num_levels, 0);
+    CHECK(voxels_per_side_ >= 2u && voxels_per_side_ % 2u == 0u)
+        << "LOD levels need an even number of voxels per side.";
+    FloatingPoint level_voxel_size = voxel_size_;
+    for (int level = 1; level <= config_.num_levels; ++level) {
+        level_voxel_size *= 2.0f;
+        layers_.emplace_back(new Layer<SSCOccupancyVoxel>(level_voxel_size, voxels_per_side_));
+    }
+    caches_.resize(config_.num_levels);
+}
+
+const Layer<SSCOccupancyVoxel>& SSCLodPyramid::getLevelLayer(int level) const {
+    CHECK(level >= 1 && level <= config_.num_levels);
+    return *layers_[level - 1];
+}
+
+void SSCLodPyramid::clear() {
+    for (int level = 1; level <= config_.num_levels; ++level) {
+        layers_[level - 1]->removeAllBlocks();
+        caches_[level - 1].clear();
+    }
+}
+
+void SSCLodPyramid::updateBlocks(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks) {
+    CHECK_EQ(layer.voxels_per_side(), voxels_per_side_);
+    IndexSet dirty_blocks;
+    for (const BlockIndex& block_idx : blocks) {
+        dirty_blocks.insert(getParentBlockIndex(block_idx));
+    }
+
+    const Layer<SSCOccupancyVoxel>* fine_layer = &layer;
+    for (int level = 1; level <= config_.num_levels && !dirty_blocks.empty(); ++level) {
+        Layer<SSCOccupancyVoxel>* coarse_layer = layers_[level - 1].get();
+        const BlockIndexList level_blocks(dirty_blocks.begin(), dirty_blocks.end());
+        dirty_blocks.clear();
+        for (const BlockIndex& block_idx : level_blocks) {
+            updateCoarseBlock(*fine_layer, block_idx, coarse_layer);
+            dirty_blocks.insert(getParentBlockIndex(block_idx));
+        }
+        caches_[level - 1].updateGeometry(*coarse_layer, level_blocks);
+        fine_layer = coarse_layer;
+    }
+}
+
+void SSCLodPyramid::updateCoarseBlock(const Layer<SSCOccupancyVoxel>& fine_layer, const BlockIndex& block_index,
+                                      Layer<SSCOccupancyVoxel>* coarse_layer) const {
+    // children ordered by octant, x is the fastest axis
+    Block<SSCOccupancyVoxel>::ConstPtr children[8];
+    bool has_children = false;
+    for (int i = 0; i < 8; ++i) {
+        const BlockIndex child_idx = 2 * block_index + BlockIndex(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+        children[i] = fine_layer.getBlockPtrByIndex(child_idx);
+        has_children |= static_cast<bool>(children[i]);
+    }
+    if (!has_children) {
+        coarse_layer->removeBlock(block_index);
+        return;
+    }
+
+    Block<SSCOccupancyVoxel>::Ptr block = coarse_layer->allocateBlockPtrByIndex(block_index);
+    const IndexElement vps = static_cast<IndexElement>(voxels_per_side_);
+    const IndexElement half = vps / 2;
+    const FloatingPoint fine_voxel_size = fine_layer.voxel_size();
+
+    VoxelIndex voxel_idx;
+    for (voxel_idx.z() = 0; voxel_idx.z() < vps; ++voxel_idx.z()) {
+        for (voxel_idx.y() = 0; voxel_idx.y() < vps; ++voxel_idx.y()) {
+            for (voxel_idx.x() = 0; voxel_idx.x() < vps; ++voxel_idx.x()) {
+                SSCOccupancyVoxel& voxel = block->getVoxelByVoxelIndex(voxel_idx);
+                const VoxelIndex octant(voxel_idx.x() >= half, voxel_idx.y() >= half, voxel_idx.z() >= half);
+                const Block<SSCOccupancyVoxel>::ConstPtr& child =
+                    children[octant.x() + 2 * octant.y() + 4 * octant.z()];
+                if (!child) {
+                    voxel = SSCOccupancyVoxel();
+                    continue;
+                }
+
+                const VoxelIndex child_voxel_idx = 2 * (voxel_idx - half * octant);
+                const SSCOccupancyVoxel* fine_voxels[8];
+                const SSCOccupancyVoxel* occupied_voxels[8];
+                size_t num_occupied = 0u;
+                float max_probability_log = 0.0f;
+                for (int i = 0; i < 8; ++i) {
+                    const SSCOccupancyVoxel& fine_voxel = child->getVoxelByVoxelIndex(
+                        child_voxel_idx + VoxelIndex(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+                    fine_voxels[i] = &fine_voxel;
+                    if (utils::isOccupied(fine_voxel, fine_voxel_size)) {
+                        max_probability_log = num_occupied == 0u
+                                                  ? fine_voxel.probability_log
+                                                  : std::max(max_probability_log, fine_voxel.probability_log);
+                        occupied_voxels[num_occupied++] = &fine_voxel;
+                    }
+                }
+
+                if (num_occupied > 0u) {
+                    // keep thin surfaces, vote among the occupied voxels only
+                    voxel = utils::majorityLabelVoxel(occupied_voxels, num_occupied, 1u);
+                    voxel.probability_log = max_probability_log;
+                } else {
+                    // same rule as upsampling, observed if most children are
+                    voxel = utils::majorityLabelVoxel(fine_voxels, 8u, 5u);
+                }
+            }
+        }
+    }
+}
+
+int SSCLodPyramid::selectLevel(FloatingPoint distance) const {
+    if (config_.fixed_level >= 0) {
+        return std::min(config_.fixed_level, config_.num_levels);
+    }
+    if (config_.level_distance <= 0.0) {
+        return 0;
+    }
+    const int level = static_cast<int>(std::floor(distance / config_.level_distance));
+    return std::max(0, std::min(level, config_.num_levels));
+}
+
+void SSCLodPyramid::createOccupiedNodes(const SSCVisualizationCache& map_cache, const Point& center,
+                                        const std::string& frame_id,
+                                        visualization_msgs::MarkerArray* marker_array) const {
+    CHECK_NOTNULL(marker_array);
+    const int top_level = config_.num_levels;
+    const FloatingPoint top_block_size =
+        voxel_size_ * voxels_per_side_ * static_cast<FloatingPoint>(1 << top_level);
+
+    // level of every top level block, selected once from the distance of its center
+    AnyIndexHashMapType<int>::type top_block_levels;
+    auto getTopBlockLevel = [&](const BlockIndex& top_block_idx) {
+        auto it = top_block_levels.find(top_block_idx);
+        if (it == top_block_levels.end()) {
+            const Point block_center = (top_block_idx.cast<FloatingPoint>() + Point::Constant(0.5f)) * top_block_size;
+            it = top_block_levels.emplace(top_block_idx, selectLevel((block_center - center).norm())).first;
+        }
+        return it->second;
+    };
+
+    FloatingPoint level_voxel_size = voxel_size_;
+    for (int level = 0; level <= top_level; ++level, level_voxel_size *= 2.0f) {
+        // every level gets a marker, possibly empty, to replace what it showed before
+        visualization_msgs::Marker level_marker;
+        level_marker.header.frame_id = frame_id;
+        level_marker.ns = "occupied_voxels_lod";
+        level_marker.id = level;
+        level_marker.type = visualization_msgs::Marker::CUBE_LIST;
+        level_marker.scale.x = level_marker.scale.y = level_marker.scale.z = level_voxel_size;
+        level_marker.pose.orientation.w = 1.0;
+        level_marker.action = visualization_msgs::Marker::ADD;
+
+        const bool level_used = config_.fixed_level < 0 || selectLevel(0.0f) == level;
+        const SSCVisualizationCache& cache = level == 0 ? map_cache : caches_[level - 1];
+        for (const auto& kv : cache.getBlockGeometry()) {
+            if (!level_used || getTopBlockLevel(getParentBlockIndex(kv.first, top_level - level)) != level) {
+                continue;
+            }
+            const SSCVisualizationCache::BlockGeometry& geometry = kv.second;
+            for (size_t i = 0u; i < geometry.points.size(); ++i) {
+                geometry_msgs::Point cube_center;
+                cube_center.x = geometry.points[i].x();
+                cube_center.y = geometry.points[i].y();
+                cube_center.z = geometry.points[i].z();
+                level_marker.points.push_back(cube_center);
+                std_msgs::ColorRGBA color_msg;
+                colorVoxbloxToMsg(geometry.colors[i], &color_msg);
+                level_marker.colors.push_back(color_msg);
+            }
+        }
+        marker_array->markers.push_back(level_marker);
+    }
+}
+
+}  // namespace voxblox
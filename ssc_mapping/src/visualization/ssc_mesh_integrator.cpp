@@ -0,0 +1,150 @@
+#include "ssc_mapping/visualization/ssc_mesh_integrator.h"
+
+#include <array>
+#include <limits>
+
+#include <voxblox/mesh/marching_cubes.h>
+
+namespace voxblox {
+
+namespace {
+// marks the free corners of a cube, below any voxel label
+constexpr int kFreeCorner = std::numeric_limits<int>::min();
+}  // namespace
+
+SSCMeshIntegrator::SSCMeshIntegrator(const SSCMap& ssc_map, MeshLayer* mesh_layer)
+    : ssc_map_(ssc_map), mesh_layer_(CHECK_NOTNULL(mesh_layer)) {
+    cube_index_offsets_ << 0, 1, 1, 0, 0, 1, 1, 0,
+                           0, 0, 1, 1, 0, 0, 1, 1,
+                           0, 0, 0, 0, 1, 1, 1, 1;
+}
+
+void SSCMeshIntegrator::generateMesh(const BlockIndexList& changed_blocks) {
+    // cubes of a block reach one voxel into the blocks in positive direction,
+    // so the blocks in negative direction of a changed block are affected as well
+    IndexSet blocks_to_mesh;
+    for (const BlockIndex& block_index : changed_blocks) {
+        for (int dx = -1; dx <= 0; ++dx) {
+            for (int dy = -1; dy <= 0; ++dy) {
+                for (int dz = -1; dz <= 0; ++dz) {
+                    blocks_to_mesh.insert(block_index + BlockIndex(dx, dy, dz));
+                }
+            }
+        }
+    }
+    for (const BlockIndex& block_index : blocks_to_mesh) {
+        updateMeshForBlock(block_index);
+    }
+}
+
+void SSCMeshIntegrator::clearMesh() {
+    BlockIndexList mesh_blocks;
+    mesh_layer_->getAllAllocatedMeshes(&mesh_blocks);
+    for (const BlockIndex& block_index : mesh_blocks) {
+        Mesh::Ptr mesh = mesh_layer_->getMeshPtrByIndex(block_index);
+        mesh->clear();
+        mesh->updated = true;
+    }
+}
+
+void SSCMeshIntegrator::updateMeshForBlock(const BlockIndex& block_index) {
+    const Layer<SSCOccupancyVoxel>& layer = ssc_map_.getSSCLayer();
+    Block<SSCOccupancyVoxel>::ConstPtr block = layer.getBlockPtrByIndex(block_index);
+    if (!block) {
+        Mesh::Ptr mesh = mesh_layer_->getMeshPtrIfExists(block_index);
+        if (mesh) {
+            mesh->clear();
+            mesh->updated = true;
+        }
+        return;
+    }
+
+    Mesh::Ptr mesh = mesh_layer_->allocateMeshPtrByIndex(block_index);
+    mesh->clear();
+    mesh->updated = true;
+
+    // cubes at the +x/+y/+z border of the block take corners from the neighbouring blocks, fetch them once
+    // indexed by (dx + 2 dy + 4 dz) for neighbour offsets in {0, 1}
+    std::array<const Block<SSCOccupancyVoxel>*, 8> corner_blocks;
+    for (int i = 0; i < 8; ++i) {
+        const BlockIndex offset((i & 1), (i >> 1) & 1, (i >> 2) & 1);
+        corner_blocks[i] = i == 0 ? block.get() : layer.getBlockPtrByIndex(block_index + offset).get();
+    }
+
+    const int vps = static_cast<int>(layer.voxels_per_side());
+    const FloatingPoint voxel_size = layer.voxel_size();
+    const GlobalIndex block_origin = block_index.cast<LongIndexElement>() * vps;
+    VertexIndex next_mesh_index = 0;
+
+    Eigen::Matrix<FloatingPoint, 3, 8> corner_coords;
+    Eigen::Matrix<FloatingPoint, 8, 1> corner_sdf;
+    std::array<int, 8> corner_labels;
+    for (int x = 0; x < vps; ++x) {
+        for (int y = 0; y < vps; ++y) {
+            for (int z = 0; z < vps; ++z) {
+                const VoxelIndex voxel_index(x, y, z);
+                bool all_observed = true;
+                bool any_occupied = false;
+                bool any_free = false;
+                for (int i = 0; i < 8; ++i) {
+                    const VoxelIndex cube_corner = voxel_index + cube_index_offsets_.col(i).cast<IndexElement>();
+                    VoxelIndex corner_index = cube_corner;
+                    int neighbour = 0;
+                    for (int d = 0; d < 3; ++d) {
+                        if (corner_index(d) == vps) {
+                            corner_index(d) = 0;
+                            neighbour |= 1 << d;
+                        }
+                    }
+                    const Block<SSCOccupancyVoxel>* corner_block = corner_blocks[neighbour];
+                    if (corner_block == nullptr) {
+                        all_observed = false;
+                        break;
+                    }
+                    const SSCOccupancyVoxel& voxel = corner_block->getVoxelByVoxelIndex(corner_index);
+                    if (!voxel.observed) {
+                        all_observed = false;
+                        break;
+                    }
+                    const GlobalIndex global_index = block_origin + cube_corner.cast<LongIndexElement>();
+                    corner_coords.col(i) = (global_index.cast<FloatingPoint>() + Point::Constant(0.5f)) * voxel_size;
+                    corner_sdf(i) = -voxel.probability_log;
+                    if (voxel.probability_log > 0.0f) {
+                        any_occupied = true;
+                        corner_labels[i] = voxel.label;
+                    } else {
+                        any_free = true;
+                        corner_labels[i] = kFreeCorner;
+                    }
+                }
+                // only cubes with both occupied and free corners hold a surface
+                if (!all_observed || !any_occupied || !any_free) {
+                    continue;
+                }
+
+                const size_t first_vertex = mesh->vertices.size();
+                MarchingCubes::meshCube(corner_coords, corner_sdf, &next_mesh_index, mesh.get());
+                // each vertex lies on an edge between an occupied and a free corner, it takes the label of the
+                // occupied corner closest to it so cubes spanning two labels keep both
+                for (size_t v = first_vertex; v < mesh->vertices.size(); ++v) {
+                    int label = kFreeCorner;
+                    FloatingPoint min_distance = std::numeric_limits<FloatingPoint>::max();
+                    for (int i = 0; i < 8; ++i) {
+                        if (corner_labels[i] == kFreeCorner) {
+                            continue;
+                        }
+                        const FloatingPoint distance = (corner_coords.col(i) - mesh->vertices[v]).squaredNorm();
+                        if (distance < min_distance) {
+                            min_distance = distance;
+                            label = corner_labels[i];
+                        }
+                    }
+                    mesh->colors.push_back(label >= 0 ? color_map_.colorLookup(static_cast<size_t>(label))
+                                                      : Color::Gray());
+                }
+            }
+        }
+    }
+}
+
+}  // namespace voxblox
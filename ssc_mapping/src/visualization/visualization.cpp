@@ -17,7 +17,35 @@ bool visualizeSSCOccupancyVoxels(const SSCOccupancyVoxel& voxel, const Point& /*
 void createPointcloudFromSSCLayer(const Layer<SSCOccupancyVoxel>& layer,
                                   pcl::PointCloud<pcl::PointXYZRGB>* pointcloud) {
     CHECK_NOTNULL(pointcloud);
-    createColorPointcloudFromLayer<SSCOccupancyVoxel>(layer, &visualizeSSCOccupancyVoxels, pointcloud);
+    BlockIndexList blocks;
+    morton::getAllAllocatedBlocks(layer, &blocks);
+    createPointcloudFromSSCBlocks(layer, blocks, pointcloud);
+}
+
+void createPointcloudFromSSCBlocks(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks,
+                                   pcl::PointCloud<pcl::PointXYZRGB>* pointcloud) {
+    CHECK_NOTNULL(pointcloud);
+    pointcloud->clear();
+    size_t vps = layer.voxels_per_side();
+    size_t num_voxels_per_block = vps * vps * vps;
+
+    for (const BlockIndex& index : blocks) {
+        const Block<SSCOccupancyVoxel>& block = layer.getBlockByIndex(index);
+        for (size_t linear_index = 0; linear_index < num_voxels_per_block; ++linear_index) {
+            Point coord = block.computeCoordinatesFromLinearIndex(linear_index);
+            Color color;
+            if (visualizeSSCOccupancyVoxels(block.getVoxelByLinearIndex(linear_index), coord, &color)) {
+                pcl::PointXYZRGB point;
+                point.x = coord.x();
+                point.y = coord.y();
+                point.z = coord.z();
+                point.r = color.r;
+                point.g = color.g;
+                point.b = color.b;
+                pointcloud->push_back(point);
+            }
+        }
+    }
 }
 
 
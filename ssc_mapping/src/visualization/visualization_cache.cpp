@@ -0,0 +1,178 @@
+#include "ssc_mapping/visualization/visualization_cache.h"
+
+#include "ssc_mapping/visualization/visualization.h"
+
+namespace voxblox {
+
+void SSCVisualizationCache::updateBlocks(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks) {
+    marker_blocks_.insert(blocks.begin(), blocks.end());
+    updateGeometry(layer, nullptr, blocks);
+}
+
+void SSCVisualizationCache::updateBlocks(const SSCMap& map, const BlockIndexList& blocks) {
+    marker_blocks_.insert(blocks.begin(), blocks.end());
+    updateGeometry(map.getSSCLayer(), &map, blocks);
+}
+
+void SSCVisualizationCache::updateGeometry(const Layer<SSCOccupancyVoxel>& layer, const BlockIndexList& blocks) {
+    updateGeometry(layer, nullptr, blocks);
+}
+
+void SSCVisualizationCache::updateGeometry(const Layer<SSCOccupancyVoxel>& layer, const SSCMap* map,
+                                           const BlockIndexList& blocks) {
+    for (const BlockIndex& block_idx : blocks) {
+        Block<SSCOccupancyVoxel>::ConstPtr block = layer.getBlockPtrByIndex(block_idx);
+        if (!block) {
+            block_geometry_.erase(block_idx);
+            continue;
+        }
+        // only observed voxels above probability 0.5 are shown, which the summary counts as occupied
+        const SSCBlockSummary* summary = map ? map->getBlockSummary(block_idx) : nullptr;
+        if (summary && !summary->hasOccupied()) {
+            block_geometry_.erase(block_idx);
+            continue;
+        }
+
+        BlockGeometry geometry;
+        for (size_t linear_index = 0u; linear_index < block->num_voxels(); ++linear_index) {
+            Point coord = block->computeCoordinatesFromLinearIndex(linear_index);
+            Color color;
+            if (visualizeSSCOccupancyVoxels(block->getVoxelByLinearIndex(linear_index), coord, &color)) {
+                geometry.points.push_back(coord);
+                geometry.colors.push_back(color);
+            }
+        }
+        if (geometry.points.empty()) {
+            block_geometry_.erase(block_idx);
+        } else {
+            block_geometry_[block_idx] = std::move(geometry);
+        }
+    }
+}
+
+void SSCVisualizationCache::clear() {
+    block_geometry_.clear();
+    marker_blocks_.clear();
+    marker_delete_all_ = true;
+}
+
+void SSCVisualizationCache::createPointcloud(pcl::PointCloud<pcl::PointXYZRGB>* pointcloud) const {
+    CHECK_NOTNULL(pointcloud);
+    pointcloud->clear();
+    size_t num_points = 0u;
+    for (const auto& kv : block_geometry_) {
+        num_points += kv.second.points.size();
+    }
+    pointcloud->reserve(num_points);
+
+    for (const auto& kv : block_geometry_) {
+        const BlockGeometry& geometry = kv.second;
+        for (size_t i = 0u; i < geometry.points.size(); ++i) {
+            pcl::PointXYZRGB point;
+            point.x = geometry.points[i].x();
+            point.y = geometry.points[i].y();
+            point.z = geometry.points[i].z();
+            point.r = geometry.colors[i].r;
+            point.g = geometry.colors[i].g;
+            point.b = geometry.colors[i].b;
+            pointcloud->push_back(point);
+        }
+    }
+}
+
+void SSCVisualizationCache::createOccupiedNodes(FloatingPoint voxel_size, const std::string& frame_id,
+                                                visualization_msgs::MarkerArray* marker_array) const {
+    CHECK_NOTNULL(marker_array);
+    visualization_msgs::Marker block_marker;
+    block_marker.header.frame_id = frame_id;
+    block_marker.ns = "occupied_voxels";
+    block_marker.id = 0;
+    block_marker.type = visualization_msgs::Marker::CUBE_LIST;
+    block_marker.scale.x = block_marker.scale.y = block_marker.scale.z = voxel_size;
+    block_marker.action = visualization_msgs::Marker::ADD;
+
+    for (const auto& kv : block_geometry_) {
+        const BlockGeometry& geometry = kv.second;
+        for (size_t i = 0u; i < geometry.points.size(); ++i) {
+            geometry_msgs::Point cube_center;
+            cube_center.x = geometry.points[i].x();
+            cube_center.y = geometry.points[i].y();
+            cube_center.z = geometry.points[i].z();
+            block_marker.points.push_back(cube_center);
+            std_msgs::ColorRGBA color_msg;
+            colorVoxbloxToMsg(geometry.colors[i], &color_msg);
+            block_marker.colors.push_back(color_msg);
+        }
+    }
+    marker_array->markers.push_back(block_marker);
+}
+
+int SSCVisualizationCache::getMarkerId(const BlockIndex& block_index) {
+    auto it = marker_ids_.find(block_index);
+    if (it == marker_ids_.end()) {
+        it = marker_ids_.emplace(block_index, next_marker_id_++).first;
+    }
+    return it->second;
+}
+
+void SSCVisualizationCache::createOccupiedNodeUpdates(FloatingPoint voxel_size, const std::string& frame_id,
+                                                      bool full_update,
+                                                      visualization_msgs::MarkerArray* marker_array) {
+    CHECK_NOTNULL(marker_array);
+    if (marker_delete_all_ || full_update) {
+        visualization_msgs::Marker delete_marker;
+        delete_marker.header.frame_id = frame_id;
+        delete_marker.ns = "occupied_voxels";
+        delete_marker.action = visualization_msgs::Marker::DELETEALL;
+        marker_array->markers.push_back(delete_marker);
+        marker_delete_all_ = false;
+        shown_blocks_.clear();
+    }
+    if (full_update) {
+        marker_blocks_.clear();
+        for (const auto& kv : block_geometry_) {
+            marker_blocks_.insert(kv.first);
+        }
+    }
+
+    for (const BlockIndex& block_idx : marker_blocks_) {
+        auto it = block_geometry_.find(block_idx);
+        if (it == block_geometry_.end() && shown_blocks_.count(block_idx) == 0u) {
+            continue;
+        }
+
+        visualization_msgs::Marker block_marker;
+        block_marker.header.frame_id = frame_id;
+        block_marker.ns = "occupied_voxels";
+        block_marker.id = getMarkerId(block_idx);
+        if (it == block_geometry_.end()) {
+            block_marker.action = visualization_msgs::Marker::DELETE;
+            marker_array->markers.push_back(block_marker);
+            shown_blocks_.erase(block_idx);
+            continue;
+        }
+        shown_blocks_.insert(block_idx);
+
+        const BlockGeometry& geometry = it->second;
+        block_marker.type = visualization_msgs::Marker::CUBE_LIST;
+        block_marker.scale.x = block_marker.scale.y = block_marker.scale.z = voxel_size;
+        block_marker.pose.orientation.w = 1.0;
+        block_marker.action = visualization_msgs::Marker::ADD;
+        block_marker.points.reserve(geometry.points.size());
+        block_marker.colors.reserve(geometry.points.size());
+        for (size_t i = 0u; i < geometry.points.size(); ++i) {
+            geometry_msgs::Point cube_center;
+            cube_center.x = geometry.points[i].x();
+            cube_center.y = geometry.points[i].y();
+            cube_center.z = geometry.points[i].z();
+            block_marker.points.push_back(cube_center);
+            std_msgs::ColorRGBA color_msg;
+            colorVoxbloxToMsg(geometry.colors[i], &color_msg);
+            block_marker.colors.push_back(color_msg);
+        }
+        marker_array->markers.push_back(block_marker);
+    }
+    marker_blocks_.clear();
+}
+
+}  // namespace voxblox
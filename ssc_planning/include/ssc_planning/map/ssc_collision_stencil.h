@@ -0,0 +1,144 @@
+#ifndef SSC_PLANNING_COLLISION_STENCIL_H_
+#define SSC_PLANNING_COLLISION_STENCIL_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <voxblox/core/block_hash.h>
+#include <voxblox/core/common.h>
+#include <voxblox/integrator/integrator_utils.h>
+#include <ssc_mapping/core/ssc_map.h>
+
+namespace active_3d_planning {
+namespace map {
+
+/**
+ * Voxels already checked along a path. A bitset over the bounding box of the
+ * swept volume, a hash set if the box is too large for one.
+ */
+class SSCVisitedVoxels {
+ public:
+  SSCVisitedVoxels(const voxblox::GlobalIndex& min_index, const voxblox::GlobalIndex& max_index);
+
+  // marks the voxel as visited, false if it already was
+  bool insert(const voxblox::GlobalIndex& global_index);
+
+ private:
+  voxblox::GlobalIndex min_index_;
+  voxblox::GlobalIndex size_;
+  std::vector<uint64_t> bits_;
+  voxblox::LongIndexSet set_;
+};
+
+/**
+ * Integer voxel offsets around a voxel checked for collisions. Offsets range
+ * over the cube of extent floor(r / vs) in each axis, r the radius and vs the
+ * voxel size. A shell keeps the offsets whose distance between voxel centers
+ * lies in [r - vs, r + vs], a solid ball all with distance <= r + vs. The
+ * offsets are computed once per collision radius and voxel size; a query
+ * looks up the few blocks the stencil touches once, skips blocks whose
+ * summary has no occupied voxels and stops at the first occupied voxel.
+ */
+class SSCCollisionStencil {
+ public:
+  SSCCollisionStencil() = default;
+  SSCCollisionStencil(double radius, double voxel_size, bool solid = false);
+
+  // recomputes the offsets if any of the parameters changed
+  void update(double radius, double voxel_size, bool solid = false);
+
+  bool empty() const { return offsets_.empty(); }
+  const voxblox::LongIndexVector& getOffsets() const { return offsets_; }
+
+  voxblox::GlobalIndex getGlobalIndex(const Eigen::Vector3d& position) const {
+    return voxblox::getGridIndexFromPoint<voxblox::GlobalIndex>(
+        position.cast<voxblox::FloatingPoint>(), static_cast<voxblox::FloatingPoint>(1.0 / voxel_size_));
+  }
+  Eigen::Vector3d getVoxelCenter(const voxblox::GlobalIndex& global_index) const {
+    return (global_index.cast<double>().array() + 0.5).matrix() * voxel_size_;
+  }
+
+  // True if no voxel of the stencil around the voxel of position is occupied.
+  // Voxels already in visited are skipped, the checked ones are added.
+  bool isCollisionFree(const voxblox::SSCMap& map, const Eigen::Vector3d& position) const;
+  bool isCollisionFree(const voxblox::SSCMap& map, const voxblox::GlobalIndex& center,
+                       SSCVisitedVoxels* visited = nullptr) const;
+
+  // Calls is_occupied(point) for the voxel centers of the stencil around position
+  // until it returns true, for maps that are not just the ssc layer.
+  template <typename Predicate>
+  bool isCollisionFree(const Eigen::Vector3d& position, const Predicate& is_occupied) const {
+    return isCollisionFree(getGlobalIndex(position), is_occupied);
+  }
+  template <typename Predicate>
+  bool isCollisionFree(const voxblox::GlobalIndex& center, const Predicate& is_occupied,
+                       SSCVisitedVoxels* visited = nullptr) const {
+    for (const voxblox::GlobalIndex& offset : offsets_) {
+      const voxblox::GlobalIndex global_idx = center + offset;
+      if (visited != nullptr && !visited->insert(global_idx)) {
+        continue;
+      }
+      if (is_occupied(getVoxelCenter(global_idx))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Calls fn(voxel) for the voxels the polyline passes through, in order,
+  // until it returns false. 3D DDA between consecutive points.
+  template <typename Function>
+  bool traversePath(const std::vector<Eigen::Vector3d>& points, const Function& fn) const {
+    if (points.size() == 1u) {
+      return fn(getGlobalIndex(points.front()));
+    }
+    const voxblox::FloatingPoint voxel_size_inv = static_cast<voxblox::FloatingPoint>(1.0 / voxel_size_);
+    voxblox::LongIndexVector voxels;
+    for (size_t i = 1u; i < points.size(); ++i) {
+      voxblox::castRay((points[i - 1] * voxel_size_inv).cast<voxblox::FloatingPoint>(),
+                       (points[i] * voxel_size_inv).cast<voxblox::FloatingPoint>(), &voxels);
+      // the first voxel of a segment is the last one of the previous segment
+      for (size_t j = i == 1u ? 0u : 1u; j < voxels.size(); ++j) {
+        if (!fn(voxels[j])) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // visited set covering the stencils around all voxels of the polyline
+  SSCVisitedVoxels createVisitedVoxels(const std::vector<Eigen::Vector3d>& points) const;
+
+  // Checks the stencils around all voxels the polyline passes through, every
+  // voxel of the swept volume is looked up once.
+  bool isPathCollisionFree(const voxblox::SSCMap& map, const std::vector<Eigen::Vector3d>& points) const;
+  template <typename Predicate>
+  bool isPathCollisionFree(const std::vector<Eigen::Vector3d>& points, const Predicate& is_occupied) const {
+    SSCVisitedVoxels visited = createVisitedVoxels(points);
+    return traversePath(points, [&](const voxblox::GlobalIndex& center) {
+      return isCollisionFree(center, is_occupied, &visited);
+    });
+  }
+
+ private:
+  template <typename IndexMath>
+  bool checkStencil(const voxblox::SSCMap& map, const voxblox::GlobalIndex& center, const IndexMath& math,
+                    SSCVisitedVoxels* visited) const;
+
+  double radius_ = -1.0;
+  double voxel_size_ = -1.0;
+  bool solid_ = false;
+
+  // sorted z, y, x so consecutive offsets mostly stay in one block
+  voxblox::LongIndexVector offsets_;
+  voxblox::GlobalIndex min_offset_ = voxblox::GlobalIndex::Zero();
+  voxblox::GlobalIndex max_offset_ = voxblox::GlobalIndex::Zero();
+};
+
+}  // namespace map
+}  // namespace active_3d_planning
+
+#endif  // SSC_PLANNING_COLLISION_STENCIL_H_
@@ -0,0 +1,86 @@
+#ifndef SSC_PLANNING_CRITERIA_H_
+#define SSC_PLANNING_CRITERIA_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <ssc_mapping/core/ssc_map.h>
+#include <ssc_mapping/core/voxel.h>
+
+namespace active_3d_planning {
+namespace map {
+
+namespace ssc_utilization_criterias {
+const std::string confidence = "confidence";
+const std::string label = "label";
+const std::string weight = "weight";
+}  // namespace ssc_utilization_criterias
+
+/**
+ * Base class to check for criteria to match inorder to use
+ * predicted map. Criteria only look at a single ssc voxel, so they
+ * can be evaluated once when the voxel is fused, see SSCCriteriaMask.
+ */
+class BaseCriteria {
+   public:
+    virtual ~BaseCriteria() = default;
+
+    virtual bool voxelVerify(const voxblox::SSCOccupancyVoxel& voxel) const = 0;
+
+    // looks the voxel up in the map, false if it is not allocated
+    bool criteriaVerify(const voxblox::SSCMap& ssc_map, const Eigen::Vector3d& position) const;
+};
+
+// occupancy probability above the threshold
+class ConfidenceCriteria : public BaseCriteria {
+   public:
+    explicit ConfidenceCriteria(const float confidence_threshold);
+
+    bool voxelVerify(const voxblox::SSCOccupancyVoxel& voxel) const override;
+
+   private:
+    // threshold converted to log odds once
+    float log_odds_threshold_;
+};
+
+// observed voxels predicted as one of the labels
+class LabelCriteria : public BaseCriteria {
+   public:
+    explicit LabelCriteria(const std::vector<int>& labels) : labels_(labels) {}
+
+    bool voxelVerify(const voxblox::SSCOccupancyVoxel& voxel) const override;
+
+   private:
+    std::vector<int> labels_;
+};
+
+// observed voxels whose label weight reached the minimum
+class WeightCriteria : public BaseCriteria {
+   public:
+    explicit WeightCriteria(const float min_weight) : min_weight_(min_weight) {}
+
+    bool voxelVerify(const voxblox::SSCOccupancyVoxel& voxel) const override;
+
+   private:
+    float min_weight_;
+};
+
+// met if all of the added criteria are met
+class AllCriteria : public BaseCriteria {
+   public:
+    void addCriteria(std::unique_ptr<BaseCriteria> criteria) { criterias_.push_back(std::move(criteria)); }
+    bool empty() const { return criterias_.empty(); }
+
+    bool voxelVerify(const voxblox::SSCOccupancyVoxel& voxel) const override;
+
+   private:
+    std::vector<std::unique_ptr<BaseCriteria>> criterias_;
+};
+
+}  // namespace map
+}  // namespace active_3d_planning
+
+#endif  // SSC_PLANNING_CRITERIA_H_
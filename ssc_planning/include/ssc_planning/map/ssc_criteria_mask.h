@@ -0,0 +1,66 @@
+#ifndef SSC_PLANNING_CRITERIA_MASK_H_
+#define SSC_PLANNING_CRITERIA_MASK_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <voxblox/core/block_hash.h>
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+#include <ssc_mapping/core/change_tracker.h>
+#include <ssc_mapping/core/voxel.h>
+#include "ssc_planning/map/ssc_criteria.h"
+
+namespace active_3d_planning {
+namespace map {
+
+/**
+ * One bit per ssc voxel telling whether the criteria are met, stored per
+ * ssc block. Updated from the change-sets of the fused blocks, so a
+ * criteria check at query time is a single block lookup and bit test.
+ * Blocks without any voxel meeting the criteria are not stored.
+ */
+class SSCCriteriaMask {
+ public:
+  // criteria has to outlive the mask
+  SSCCriteriaMask(const BaseCriteria& criteria, const voxblox::Layer<voxblox::SSCOccupancyVoxel>& ssc_layer);
+
+  // re-evaluates the changed voxels, whole blocks if the change-set has no voxel masks
+  void updateFromChangeSet(const voxblox::SSCChangeSet& change_set);
+
+  // re-evaluates all voxels of the given blocks
+  void updateFromSSCBlocks(const voxblox::BlockIndexList& ssc_blocks);
+
+  // re-evaluates the whole layer
+  void rebuild();
+
+  void clear() { blocks_.clear(); }
+
+  size_t getNumberOfBlocks() const { return blocks_.size(); }
+
+  bool isSatisfied(const voxblox::GlobalIndex& global_index) const;
+  bool isSatisfiedAtPosition(const Eigen::Vector3d& position) const;
+
+ private:
+  typedef std::vector<uint64_t> BlockMask;
+
+  void updateBlock(const voxblox::BlockIndex& block_index);
+
+  // only re-evaluates the voxels set in voxel_mask, the block has to be stored already
+  void updateVoxels(const voxblox::BlockIndex& block_index, const std::vector<bool>& voxel_mask,
+                    BlockMask* block_mask);
+
+  const BaseCriteria& criteria_;
+  const voxblox::Layer<voxblox::SSCOccupancyVoxel>& ssc_layer_;
+  const size_t voxels_per_side_;
+  const size_t num_voxels_;
+
+  voxblox::AnyIndexHashMapType<BlockMask>::type blocks_;
+};
+
+}  // namespace map
+}  // namespace active_3d_planning
+
+#endif  // SSC_PLANNING_CRITERIA_MASK_H_
@@ -0,0 +1,79 @@
+#ifndef SSC_PLANNING_FRONTIER_LAYER_H_
+#define SSC_PLANNING_FRONTIER_LAYER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <voxblox/core/block_hash.h>
+#include <voxblox/core/common.h>
+#include "ssc_planning/map/ssc_planning_state_layer.h"
+
+namespace active_3d_planning {
+namespace map {
+
+/**
+ * Frontier voxels of the planning state layer: unknown voxels next to a free
+ * voxel, or to an occupied one if surface_frontiers is set. Same definition
+ * as FrontierEvaluator::isFrontierVoxel, but kept as one bit per voxel in
+ * blocks that are recomputed only around the changed state blocks, so a
+ * frontier check is a single bit test and the frontiers can be enumerated.
+ */
+class SSCFrontierLayer {
+ public:
+  struct Config {
+    // check all 26 neighbors instead of the 6 face neighbors
+    bool accurate_frontiers = false;
+    // unknown voxels next to occupied voxels are frontiers as well
+    bool surface_frontiers = true;
+  };
+
+  // the state layer has to outlive the frontier layer
+  SSCFrontierLayer(const Config& config, const SSCPlanningStateLayer& state_layer, voxblox::FloatingPoint voxel_size);
+
+  // recomputes the voxels within one voxel of the changed state blocks
+  void updateFromStateBlocks(const voxblox::BlockIndexList& state_blocks);
+
+  // recomputes everything from the state layer
+  void rebuild();
+
+  void clear();
+
+  const Config& getConfig() const { return config_; }
+  size_t getNumberOfBlocks() const { return blocks_.size(); }
+  size_t getNumberOfFrontierVoxels() const { return num_frontier_voxels_; }
+
+  bool isFrontier(const voxblox::GlobalIndex& global_index) const;
+  bool isFrontierAtPosition(const Eigen::Vector3d& position) const;
+
+  // all frontier voxels, e.g. to sample exploration goals from
+  void getFrontierVoxels(voxblox::LongIndexVector* frontier_voxels) const;
+
+ private:
+  struct FrontierBlock {
+    std::vector<uint64_t> bits;
+    size_t count = 0u;
+  };
+
+  // recomputes the voxels in [min_index, max_index] from the states around them
+  void updateRegion(const voxblox::GlobalIndex& min_index, const voxblox::GlobalIndex& max_index);
+
+  const Config config_;
+  const SSCPlanningStateLayer& state_layer_;
+  const size_t voxels_per_side_;
+  const size_t num_voxels_;
+  const voxblox::FloatingPoint voxel_size_inv_;
+  std::vector<voxblox::GlobalIndex> neighbor_offsets_;
+
+  voxblox::AnyIndexHashMapType<FrontierBlock>::type blocks_;
+  size_t num_frontier_voxels_ = 0u;
+
+  // scratch space of updateRegion
+  std::vector<SSCPlanningStateLayer::State> states_;
+};
+
+}  // namespace map
+}  // namespace active_3d_planning
+
+#endif  // SSC_PLANNING_FRONTIER_LAYER_H_
@@ -2,10 +2,14 @@
 #define SSC_3D_PLANNING_MAP_H_
 
 #include <memory>
+#include <vector>
 
 #include <active_3d_planning_core/module/module_factory_registry.h>
 #include <ssc_mapping/utils/voxel_utils.h>
+#include <ssc_mapping/ros/ssc_layer_client.h>
+#include <ssc_mapping/core/esdf_integrator.h>
 #include <ssc_mapping/ros/ssc_server.h>
+#include "ssc_planning/map/ssc_collision_stencil.h"
 
 #include <active_3d_planning_core/map/occupancy_map.h>
 
@@ -26,6 +30,11 @@ class SSCOccupancyMap : public OccupancyMap {
   bool isTraversable(const Eigen::Vector3d& position,
                      const Eigen::Quaterniond& orientation) override;
 
+  // Checks the poses along a polyline, e.g. the points of a trajectory segment.
+  // Same as isTraversable for every voxel the polyline passes through, but
+  // each voxel around the path is looked up once.
+  bool isTraversablePath(const std::vector<Eigen::Vector3d>& points);
+
   // check whether point is part of the map
   bool isObserved(const Eigen::Vector3d& point) override;
 
@@ -39,7 +48,7 @@ class SSCOccupancyMap : public OccupancyMap {
   bool getVoxelCenter(Eigen::Vector3d* center,
                       const Eigen::Vector3d& point) override;
 
-  // accessor to the server for specialized planners
+  // accessor to the server for specialized planners, only set if the map is fused locally
   voxblox::SSCServer& getSSCServer();
 
  protected:
@@ -48,9 +57,27 @@ class SSCOccupancyMap : public OccupancyMap {
   // esdf server that contains the map, subscribe to external ESDF/TSDF updates
   std::unique_ptr<voxblox::SSCServer> ssc_server_;
 
+  // mirrors the map of a remote ssc server instead if ssc_layer_topic is set
+  std::unique_ptr<voxblox::SSCLayerClient> ssc_layer_client_;
+
+  // map of either of the two
+  std::shared_ptr<voxblox::SSCMap> ssc_map_;
+
+  // voxels checked around a pose by isTraversable, a sphere shell unless collision_solid_ball is set
+  SSCCollisionStencil collision_stencil_;
+  bool collision_solid_ball_ = false;
+
+  // distance field of the occupied ssc voxels, answers isTraversable with one lookup if use_ssc_esdf is set.
+  // Free means no occupied voxel center within collision_radius + voxel size, the reach of the collision stencil.
+  voxblox::Layer<voxblox::SSCEsdfVoxel>::Ptr ssc_esdf_layer_;
+  std::unique_ptr<voxblox::SSCEsdfIntegrator> ssc_esdf_integrator_;
+
   // cache constants
   double c_voxel_size_;
   double c_block_size_;
+
+  // creates the distance field and keeps it updated from the change-sets of the ssc map
+  void setupSSCEsdf(const voxblox::SSCEsdfIntegrator::Config& config);
 };
 
 }  // namespace map
@@ -0,0 +1,120 @@
+#ifndef SSC_PLANNING_STATE_LAYER_H_
+#define SSC_PLANNING_STATE_LAYER_H_
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <voxblox/core/block_hash.h>
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+#include <voxblox/core/voxel.h>
+#include <ssc_mapping/core/voxel.h>
+
+namespace active_3d_planning {
+namespace map {
+
+// Inserts the blocks of a layer with voxels_per_side that overlap a block of a
+// layer with other_voxels_per_side, both layers having the same voxel size.
+void insertOverlappingBlocks(const voxblox::BlockIndex& other_block_index, size_t other_voxels_per_side,
+                             size_t voxels_per_side, voxblox::IndexSet* blocks);
+
+/**
+ * Occupancy the planner sees per voxel, fused from the measured esdf layer
+ * and the predicted ssc layer. Stored bit-packed per ssc block, 2 bits of
+ * state and 1 bit telling whether the state came from the prediction, so a
+ * state query is a single block lookup. The layer is kept up to date from
+ * the blocks changed in either map.
+ */
+class SSCPlanningStateLayer {
+ public:
+  enum State : uint8_t { kUnknown = 0u, kFree = 1u, kOccupied = 2u };
+
+  struct Config {
+    // use the measured esdf map where it is observed
+    bool use_measured = true;
+    // use the predicted ssc map where the measured map is not observed
+    bool use_predicted = true;
+    // measured voxels closer than this to a surface are occupied, <= 0 uses the voxel size
+    float occupied_distance = 0.0f;
+    // ssc voxels above this log odds are occupied
+    float occupied_log_odds = 0.0f;
+    // ssc voxels above this log odds are occupied even if the measured map
+    // says otherwise, disabled by default
+    float confident_log_odds = std::numeric_limits<float>::infinity();
+    // replaces confident_log_odds if set, e.g. by the utilization criteria of the criteria map
+    std::function<bool(const voxblox::SSCOccupancyVoxel&)> confident_criteria;
+  };
+
+  // blocks of the esdf layer changed by the esdf server are expected to have
+  // Update::kEsdf set, updateFromEsdfLayer consumes that flag
+  SSCPlanningStateLayer(const Config& config, const voxblox::Layer<voxblox::SSCOccupancyVoxel>& ssc_layer,
+                        voxblox::Layer<voxblox::EsdfVoxel>* esdf_layer);
+
+  // The update methods append the state blocks whose voxels changed to
+  // changed_blocks if it is set.
+
+  // recomputes the voxels of the given ssc blocks
+  void updateFromSSCBlocks(const voxblox::BlockIndexList& ssc_blocks,
+                           voxblox::BlockIndexList* changed_blocks = nullptr);
+
+  // recomputes the voxels of all esdf blocks flagged with Update::kEsdf and clears the flag
+  void updateFromEsdfLayer(voxblox::BlockIndexList* changed_blocks = nullptr);
+
+  // recomputes the voxels of the given esdf blocks
+  void updateFromEsdfBlocks(const voxblox::BlockIndexList& esdf_blocks,
+                            voxblox::BlockIndexList* changed_blocks = nullptr);
+
+  // recomputes everything from both layers
+  void rebuild();
+
+  void clear() { blocks_.clear(); }
+
+  const Config& getConfig() const { return config_; }
+  size_t getNumberOfBlocks() const { return blocks_.size(); }
+  size_t voxels_per_side() const { return voxels_per_side_; }
+
+  // blocks with at least one known voxel
+  void getAllBlocks(voxblox::BlockIndexList* blocks) const;
+
+  // predicted is set if the state comes from the ssc map
+  State getState(const voxblox::GlobalIndex& global_index, bool* predicted = nullptr) const;
+  State getStateAtPosition(const Eigen::Vector3d& position, bool* predicted = nullptr) const;
+
+  // states of all voxels in the box [min_index, max_index], x running fastest,
+  // looks every overlapped block up once
+  void getStates(const voxblox::GlobalIndex& min_index, const voxblox::GlobalIndex& max_index,
+                 std::vector<State>* states) const;
+
+ private:
+  // 2 state bits per voxel, 32 voxels per word, and one prediction bit per voxel
+  struct PackedBlock {
+    std::vector<uint64_t> states;
+    std::vector<uint64_t> predicted;
+  };
+
+  State computeState(const voxblox::EsdfVoxel* esdf_voxel, const voxblox::SSCOccupancyVoxel* ssc_voxel,
+                     bool* predicted) const;
+
+  // recomputes all voxels of one state block, blocks without data in either layer are
+  // dropped. Returns whether any voxel changed.
+  bool updateBlock(const voxblox::BlockIndex& block_index);
+
+  const Config config_;
+  const voxblox::Layer<voxblox::SSCOccupancyVoxel>& ssc_layer_;
+  voxblox::Layer<voxblox::EsdfVoxel>* esdf_layer_;
+  const size_t voxels_per_side_;
+  const size_t esdf_voxels_per_side_;
+  const size_t num_voxels_;
+  const float occupied_distance_;
+
+  voxblox::AnyIndexHashMapType<PackedBlock>::type blocks_;
+};
+
+}  // namespace map
+}  // namespace active_3d_planning
+
+#endif  // SSC_PLANNING_STATE_LAYER_H_
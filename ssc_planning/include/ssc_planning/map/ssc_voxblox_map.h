@@ -2,10 +2,17 @@
 #define SSC_VOXBLOX_3D_PLANNING_MAP_H_
 
 #include <memory>
+#include <vector>
 
 #include <active_3d_planning_core/module/module_factory_registry.h>
 #include <ssc_mapping/utils/voxel_utils.h>
+#include <ssc_mapping/ros/ssc_layer_client.h>
+#include <ssc_mapping/core/esdf_integrator.h>
 #include <ssc_mapping/ros/ssc_server.h>
+#include "ssc_planning/map/ssc_collision_stencil.h"
+#include "ssc_planning/map/ssc_frontier_layer.h"
+#include "ssc_planning/map/ssc_planning_state_layer.h"
+#include <ros/callback_queue.h>
 #include <voxblox_ros/esdf_server.h>
 #include <active_3d_planning_core/map/occupancy_map.h>
 
@@ -18,6 +25,22 @@ namespace map {
  */ 
 class SSCVoxbloxOccupancyMap : public OccupancyMap {
  public:
+  // everything the planner needs to know about one voxel, from both maps
+  struct VoxelQuery {
+    // state in the measured esdf map, UNKNOWN if not observed there
+    unsigned char measured_state = OccupancyMap::UNKNOWN;
+    // state in the ssc map, UNKNOWN if not observed there
+    unsigned char predicted_state = OccupancyMap::UNKNOWN;
+    // ssc occupancy probability in LogOdds, 0 if the voxel is not allocated
+    float log_prob = 0.0f;
+    // observed by the measured esdf map
+    bool observed = false;
+    // frontier voxel, only set if the frontier layer is enabled
+    bool frontier = false;
+    // combined occupancy the map uses for the point, see computeQueryStates
+    unsigned char state = OccupancyMap::UNKNOWN;
+  };
+
   explicit SSCVoxbloxOccupancyMap(PlannerI& planner);
 
   // implement virtual methods
@@ -27,6 +50,11 @@ class SSCVoxbloxOccupancyMap : public OccupancyMap {
   bool isTraversable(const Eigen::Vector3d& position,
                      const Eigen::Quaterniond& orientation) override;
 
+  // Checks the poses along a polyline, e.g. the points of a trajectory segment.
+  // Same as isTraversable for every voxel the polyline passes through, but
+  // each ssc voxel around the path is looked up once.
+  bool isTraversablePath(const std::vector<Eigen::Vector3d>& points);
+
   // check whether point is part of the map
   bool isObserved(const Eigen::Vector3d& point) override;
 
@@ -43,9 +71,45 @@ class SSCVoxbloxOccupancyMap : public OccupancyMap {
   // get the voxel occupancy probability in LogOdds
   double getVoxelLogProb(const Eigen::Vector3d& point);
 
-  // accessor to the servers for specialized planners
+  // Queries both maps for all points at once. The points are sorted by block
+  // so every block is looked up once per layer, num_threads splits the sorted
+  // points, 0 uses all hardware threads.
+  void getVoxelStates(const std::vector<Eigen::Vector3d>& points, std::vector<VoxelQuery>* queries,
+                      size_t num_threads = 1u);
+
+  // combined occupancy of a query, same as getVoxelState for its point
+  unsigned char getVoxelState(const VoxelQuery& query) const { return query.state; }
+
+  // frontier voxels maintained from the changed blocks of both maps if use_frontier_layer is set
+  bool hasFrontierLayer() const { return frontier_layer_ != nullptr; }
+  // whether the frontier layer uses the given frontier definition, callers with another one compute their own
+  bool hasFrontierLayer(const SSCFrontierLayer::Config& config) const {
+    return frontier_layer_ && frontier_layer_->getConfig().accurate_frontiers == config.accurate_frontiers &&
+           frontier_layer_->getConfig().surface_frontiers == config.surface_frontiers;
+  }
+  bool isFrontierVoxel(const Eigen::Vector3d& point);
+
+  // centers of all frontier voxels, e.g. to sample exploration goals from
+  void getFrontierVoxels(std::vector<Eigen::Vector3d>* centers);
+
+  // Version of the planner's view of both maps, bumped whenever ssc or esdf
+  // blocks change. Results computed from the map at a version stay valid
+  // until getChangedBlocks reports their blocks as changed since then.
+  uint64_t getMapVersion();
+
+  // sets changed[i] if blocks[i] changed after version, or one of its
+  // neighbors if include_neighbors is set, e.g. for results that look at
+  // neighboring voxels
+  void getChangedBlocks(const voxblox::BlockIndexList& blocks, uint64_t version, bool include_neighbors,
+                        std::vector<bool>* changed);
+
+  // ssc block of a point, the unit getChangedBlocks works in
+  voxblox::BlockIndex getBlockIndex(const Eigen::Vector3d& point) const;
+
+  // accessor to the servers for specialized planners, the ssc server is only set if the map is fused locally
   voxblox::SSCServer& getSSCServer();
 
+  // the esdf layer is only updated under the write lock of the ssc map, read it with its read lock held
   voxblox::EsdfServer& getESDFServer();
 
  protected:
@@ -54,23 +118,95 @@ class SSCVoxbloxOccupancyMap : public OccupancyMap {
   // esdf server that contains the map, subscribe to external ESDF/TSDF updates
   std::unique_ptr<voxblox::SSCServer> ssc_server_;
 
+  // mirrors the map of a remote ssc server instead if ssc_layer_topic is set
+  std::unique_ptr<voxblox::SSCLayerClient> ssc_layer_client_;
+
+  // map of either of the two
+  std::shared_ptr<voxblox::SSCMap> ssc_map_;
+
+  // The esdf server runs its subscriber, timer and service callbacks on its
+  // own queue, which is serviced under the write lock of the ssc map. Planner
+  // queries under the read lock then never see the esdf layer change, also
+  // with a multi-threaded spinner. Declared before the server, which removes
+  // its callbacks from the queue when it is destroyed.
+  ros::CallbackQueue esdf_callback_queue_;
   std::unique_ptr<voxblox::EsdfServer> esdf_server_;
+  ros::WallTimer esdf_callback_timer_;
 
   // use ssc map for planning
-  bool use_ssc_planning_;
+  bool use_ssc_planning_ = false;
 
   // use measured voxblox measured map for planning
-  bool use_voxblox_planning_;
+  bool use_voxblox_planning_ = true;
 
   // whether to use ssc map for information planning
-  bool use_ssc_information_planning_;
+  bool use_ssc_information_planning_ = true;
 
   // use measured voxblox measured map for information planning
-  bool use_voxblox_information_planning_;
+  bool use_voxblox_information_planning_ = true;
+
+  // voxels checked around a pose by isTraversable, a sphere shell unless collision_solid_ball is set
+  SSCCollisionStencil collision_stencil_;
+  bool collision_solid_ball_ = false;
+
+  // distance field of the occupied ssc voxels, answers isTraversable with one lookup if use_ssc_esdf is set
+  // and only the ssc map is used for information planning. Free means no occupied voxel center within
+  // collision_radius + voxel size, the reach of the collision stencil.
+  voxblox::Layer<voxblox::SSCEsdfVoxel>::Ptr ssc_esdf_layer_;
+  std::unique_ptr<voxblox::SSCEsdfIntegrator> ssc_esdf_integrator_;
+
+  // fused per voxel state of both maps, answers getVoxelState with one lookup if use_state_layer is set
+  std::unique_ptr<SSCPlanningStateLayer> state_layer_;
+
+  // unknown voxels next to known ones in the state layer, updated with it
+  std::unique_ptr<SSCFrontierLayer> frontier_layer_;
+
+  // version of each ssc block, blocks changed before reset_version_ are not listed
+  uint64_t map_version_ = 0u;
+  uint64_t reset_version_ = 0u;
+  voxblox::AnyIndexHashMapType<uint64_t>::type block_versions_;
+
+  // polls the esdf blocks flagged with Update::kEsdf, the esdf server has no change notification
+  ros::Timer esdf_update_timer_;
 
   // cache constants
   double c_voxel_size_;
   double c_block_size_;
+
+  // isTraversable for callers holding the read lock of the ssc map, visited
+  // skips the ssc voxels already checked along a path
+  virtual bool isTraversableAt(const Eigen::Vector3d& position, SSCVisitedVoxels* visited);
+
+  // getVoxelState without taking the read lock of the ssc map, for callers holding it
+  virtual unsigned char computeVoxelState(const Eigen::Vector3d& point);
+
+  // sets the state of the queries from the looked up voxels, same as
+  // computeVoxelState for their points, called by getVoxelStates with the read lock held
+  virtual void computeQueryStates(const std::vector<Eigen::Vector3d>& points, std::vector<VoxelQuery>* queries,
+                                  size_t num_threads);
+
+  // node handles that put the callbacks of the esdf server on esdf_callback_queue_,
+  // and the timer that services the queue, call setupEsdfCallbacks once the server exists
+  ros::NodeHandle getEsdfNodeHandle(const ros::NodeHandle& nh);
+  void setupEsdfCallbacks();
+  void esdfCallbacksEvent(const ros::WallTimerEvent& event);
+
+  // creates the distance field and keeps it updated from the change-sets of the ssc map
+  void setupSSCEsdf(const voxblox::SSCEsdfIntegrator::Config& config);
+
+  // tracks the block versions, ssc changes are applied as they are committed,
+  // esdf changes are polled every update_period seconds and passed on to the
+  // state and frontier layers. Set up last, after the other layers.
+  void setupBlockVersions(double update_period);
+  void updateEsdfBlocksEvent(const ros::TimerEvent& event);
+  void markBlocksChanged(const voxblox::BlockIndexList& ssc_blocks);
+
+  // creates the state layer, esdf changes reach it through updateEsdfBlocksEvent
+  void setupStateLayer(const SSCPlanningStateLayer::Config& config);
+
+  // creates the frontier layer on top of the state layer, which has to be set up
+  void setupFrontierLayer(const SSCFrontierLayer::Config& config);
+  unsigned char getStateLayerVoxelState(const Eigen::Vector3d& point) const;
 };
 
 }  // namespace map
@@ -11,6 +11,18 @@
 namespace active_3d_planning {
 namespace trajectory_evaluator {
 
+// Visible voxels of a segment with their gains, grouped by ssc block. The
+// gains are valid for map_version, only blocks changed since then are
+// recomputed.
+struct SSCVoxelInfo : public SimulatedSensorInfo {
+  std::vector<double> voxel_gains;
+  voxblox::BlockIndexList blocks;
+  // indices into visible_voxels per block
+  std::vector<std::vector<size_t>> block_voxels;
+  uint64_t map_version = 0u;
+  bool valid = false;
+};
+
 // SSCVoxelEvaluator uses the voxel log prob to estimate how much they
 // can still change with additional observations. Requires the SSC map to
 // published to the planner intern voxblox ssc server. Uses frontier voxels to allow
@@ -50,13 +62,22 @@ class SSCVoxelEvaluator : public FrontierEvaluator {
   double p_max_log_prob_;  // Max log probability for a voxel, beyond which its not considered in gain
   // weight of log prob for gain computation
   double p_log_prob_weight_;
+  // threads for the batched voxel queries of the visible voxels, 0 uses all
+  int p_query_threads_;
+  // keep the voxel gains of the segments and only recompute the changed blocks
+  bool p_cache_gains_;
 
   // constants
   double c_voxel_size_;
+  // the frontier layer of the map uses the frontier settings of this evaluator
+  bool c_use_frontier_layer_;
 
   // methods
   double getVoxelValue(const Eigen::Vector3d& voxel,
-                       const Eigen::Vector3d& origin);
+                       const map::SSCVoxbloxOccupancyMap::VoxelQuery& query);
+
+  // recomputes the gains of the voxels in blocks changed since they were cached
+  void updateVoxelGains(SSCVoxelInfo* info);
 };
 
 }  // namespace trajectory_evaluator
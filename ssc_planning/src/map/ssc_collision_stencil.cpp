@@ -0,0 +1,180 @@
+#include "ssc_planning/map/ssc_collision_stencil.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+#include <ssc_mapping/utils/block_index_math.h>
+
+namespace active_3d_planning {
+namespace map {
+
+SSCVisitedVoxels::SSCVisitedVoxels(const voxblox::GlobalIndex& min_index, const voxblox::GlobalIndex& max_index)
+    : min_index_(min_index), size_(max_index - min_index + voxblox::GlobalIndex::Ones()) {
+  // up to 2^24 voxels, 2 MB of bits
+  constexpr voxblox::LongIndexElement kMaxBits = voxblox::LongIndexElement(1) << 24;
+  if ((size_.array() > 0).all() && size_.x() <= kMaxBits && size_.y() <= kMaxBits &&
+      size_.x() * size_.y() <= kMaxBits && size_.x() * size_.y() * size_.z() <= kMaxBits) {
+    bits_.assign(static_cast<size_t>((size_.x() * size_.y() * size_.z() + 63) / 64), 0u);
+  }
+}
+
+bool SSCVisitedVoxels::insert(const voxblox::GlobalIndex& global_index) {
+  const voxblox::GlobalIndex local = global_index - min_index_;
+  if (bits_.empty() || (local.array() < 0).any() || (local.array() >= size_.array()).any()) {
+    return set_.insert(global_index).second;
+  }
+  const size_t bit = static_cast<size_t>(local.x() + size_.x() * (local.y() + size_.y() * local.z()));
+  const uint64_t mask = uint64_t(1u) << (bit & 63u);
+  if (bits_[bit >> 6] & mask) {
+    return false;
+  }
+  bits_[bit >> 6] |= mask;
+  return true;
+}
+
+SSCCollisionStencil::SSCCollisionStencil(double radius, double voxel_size, bool solid) {
+  update(radius, voxel_size, solid);
+}
+
+void SSCCollisionStencil::update(double radius, double voxel_size, bool solid) {
+  if (radius == radius_ && voxel_size == voxel_size_ && solid == solid_) {
+    return;
+  }
+  CHECK_GT(voxel_size, 0.0);
+  radius_ = radius;
+  voxel_size_ = voxel_size;
+  solid_ = solid;
+
+  offsets_.clear();
+  min_offset_ = voxblox::GlobalIndex::Zero();
+  max_offset_ = voxblox::GlobalIndex::Zero();
+  if (radius < 0.0) {
+    return;
+  }
+
+  // cube of extent floor(r / vs), keeping center distances in [r - vs, r + vs] (shell) or <= r + vs (solid)
+  const voxblox::LongIndexElement extent =
+      static_cast<voxblox::LongIndexElement>(std::floor(radius / voxel_size + 1e-6));
+  for (voxblox::LongIndexElement z = -extent; z <= extent; ++z) {
+    for (voxblox::LongIndexElement y = -extent; y <= extent; ++y) {
+      for (voxblox::LongIndexElement x = -extent; x <= extent; ++x) {
+        const double distance = voxel_size * std::sqrt(static_cast<double>(x * x + y * y + z * z));
+        if (distance > radius + voxel_size || (!solid && distance < radius - voxel_size)) {
+          continue;
+        }
+        const voxblox::GlobalIndex offset(x, y, z);
+        offsets_.push_back(offset);
+        min_offset_ = min_offset_.cwiseMin(offset);
+        max_offset_ = max_offset_.cwiseMax(offset);
+      }
+    }
+  }
+}
+
+bool SSCCollisionStencil::isCollisionFree(const voxblox::SSCMap& map, const Eigen::Vector3d& position) const {
+  const voxblox::GlobalIndex center = voxblox::getGridIndexFromPoint<voxblox::GlobalIndex>(
+      position.cast<voxblox::FloatingPoint>(), map.getSSCLayer().voxel_size_inv());
+  return isCollisionFree(map, center);
+}
+
+bool SSCCollisionStencil::isCollisionFree(const voxblox::SSCMap& map, const voxblox::GlobalIndex& center,
+                                          SSCVisitedVoxels* visited) const {
+  return voxblox::dispatchBlockIndexMath(map.getSSCLayer().voxels_per_side(), [&](const auto& math) {
+    return checkStencil(map, center, math, visited);
+  });
+}
+
+SSCVisitedVoxels SSCCollisionStencil::createVisitedVoxels(const std::vector<Eigen::Vector3d>& points) const {
+  if (points.empty()) {
+    return SSCVisitedVoxels(voxblox::GlobalIndex::Zero(), voxblox::GlobalIndex::Zero());
+  }
+  voxblox::GlobalIndex min_index = getGlobalIndex(points.front());
+  voxblox::GlobalIndex max_index = min_index;
+  for (const Eigen::Vector3d& point : points) {
+    const voxblox::GlobalIndex index = getGlobalIndex(point);
+    min_index = min_index.cwiseMin(index);
+    max_index = max_index.cwiseMax(index);
+  }
+  return SSCVisitedVoxels(min_index + min_offset_, max_index + max_offset_);
+}
+
+bool SSCCollisionStencil::isPathCollisionFree(const voxblox::SSCMap& map,
+                                              const std::vector<Eigen::Vector3d>& points) const {
+  SSCVisitedVoxels visited = createVisitedVoxels(points);
+  return voxblox::dispatchBlockIndexMath(map.getSSCLayer().voxels_per_side(), [&](const auto& math) {
+    return traversePath(points, [&](const voxblox::GlobalIndex& center) {
+      return checkStencil(map, center, math, &visited);
+    });
+  });
+}
+
+template <typename IndexMath>
+bool SSCCollisionStencil::checkStencil(const voxblox::SSCMap& map, const voxblox::GlobalIndex& center,
+                                       const IndexMath& math, SSCVisitedVoxels* visited) const {
+  typedef voxblox::Block<voxblox::SSCOccupancyVoxel> SSCBlock;
+  const voxblox::Layer<voxblox::SSCOccupancyVoxel>& layer = map.getSSCLayer();
+  const float occupied_log_odds = voxblox::logOddsFromProbability(0.5f);
+
+  // blocks touched by the stencil, looked up once. Blocks known to hold no
+  // occupied voxels are left out. Radii spanning more blocks than fit in the
+  // table fall back to a lookup per voxel.
+  constexpr size_t kMaxBlocks = 64u;
+  const voxblox::BlockIndex min_block = math.computeBlockIndex(center + min_offset_);
+  const voxblox::BlockIndex num_blocks = math.computeBlockIndex(center + max_offset_) - min_block +
+                                         voxblox::BlockIndex::Ones();
+  const size_t table_size = static_cast<size_t>(num_blocks.x()) * num_blocks.y() * num_blocks.z();
+  if (table_size > kMaxBlocks) {
+    for (const voxblox::GlobalIndex& offset : offsets_) {
+      if (visited != nullptr && !visited->insert(center + offset)) {
+        continue;
+      }
+      const voxblox::SSCOccupancyVoxel* voxel = map.getVoxelPtrByGlobalIndex(center + offset);
+      if (voxel != nullptr && voxel->observed && voxel->probability_log > occupied_log_odds) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::array<const SSCBlock*, kMaxBlocks> blocks;
+  bool any_block = false;
+  size_t slot = 0u;
+  voxblox::BlockIndex block_idx;
+  for (block_idx.z() = 0; block_idx.z() < num_blocks.z(); ++block_idx.z()) {
+    for (block_idx.y() = 0; block_idx.y() < num_blocks.y(); ++block_idx.y()) {
+      for (block_idx.x() = 0; block_idx.x() < num_blocks.x(); ++block_idx.x(), ++slot) {
+        const voxblox::BlockIndex index = min_block + block_idx;
+        const voxblox::SSCBlockSummary* summary = map.getBlockSummary(index);
+        const bool has_occupied = summary == nullptr || summary->hasOccupied();
+        blocks[slot] = has_occupied ? layer.getBlockPtrByIndex(index).get() : nullptr;
+        any_block |= blocks[slot] != nullptr;
+      }
+    }
+  }
+  if (!any_block) {
+    return true;
+  }
+
+  for (const voxblox::GlobalIndex& offset : offsets_) {
+    const voxblox::GlobalIndex global_idx = center + offset;
+    if (visited != nullptr && !visited->insert(global_idx)) {
+      continue;
+    }
+    const voxblox::BlockIndex local_block = math.computeBlockIndex(global_idx) - min_block;
+    const SSCBlock* block =
+        blocks[local_block.x() + num_blocks.x() * (local_block.y() + num_blocks.y() * local_block.z())];
+    if (block == nullptr) {
+      continue;
+    }
+    const voxblox::SSCOccupancyVoxel& voxel = block->getVoxelByLinearIndex(math.computeLinearIndex(global_idx));
+    if (voxel.observed && voxel.probability_log > occupied_log_odds) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace map
+}  // namespace active_3d_planning
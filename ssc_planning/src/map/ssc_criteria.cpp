@@ -0,0 +1,40 @@
+#include "ssc_planning/map/ssc_criteria.h"
+
+#include <algorithm>
+
+#include <voxblox/core/common.h>
+
+namespace active_3d_planning {
+namespace map {
+
+bool BaseCriteria::criteriaVerify(const voxblox::SSCMap& ssc_map, const Eigen::Vector3d& position) const {
+    const voxblox::SSCOccupancyVoxel* voxel = ssc_map.getVoxelPtrByCoordinates(position);
+    return voxel != nullptr && voxelVerify(*voxel);
+}
+
+ConfidenceCriteria::ConfidenceCriteria(const float confidence_threshold)
+    : log_odds_threshold_(voxblox::logOddsFromProbability(confidence_threshold)) {}
+
+bool ConfidenceCriteria::voxelVerify(const voxblox::SSCOccupancyVoxel& voxel) const {
+    return voxel.probability_log > log_odds_threshold_;
+}
+
+bool LabelCriteria::voxelVerify(const voxblox::SSCOccupancyVoxel& voxel) const {
+    return voxel.observed && std::find(labels_.begin(), labels_.end(), voxel.label) != labels_.end();
+}
+
+bool WeightCriteria::voxelVerify(const voxblox::SSCOccupancyVoxel& voxel) const {
+    return voxel.observed && voxel.label_weight >= min_weight_;
+}
+
+bool AllCriteria::voxelVerify(const voxblox::SSCOccupancyVoxel& voxel) const {
+    for (const std::unique_ptr<BaseCriteria>& criteria : criterias_) {
+        if (!criteria->voxelVerify(voxel)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace map
+}  // namespace active_3d_planning
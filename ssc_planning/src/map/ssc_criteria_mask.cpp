@@ -0,0 +1,108 @@
+#include "ssc_planning/map/ssc_criteria_mask.h"
+
+#include <utility>
+
+namespace active_3d_planning {
+namespace map {
+
+SSCCriteriaMask::SSCCriteriaMask(const BaseCriteria& criteria,
+                                 const voxblox::Layer<voxblox::SSCOccupancyVoxel>& ssc_layer)
+    : criteria_(criteria),
+      ssc_layer_(ssc_layer),
+      voxels_per_side_(ssc_layer.voxels_per_side()),
+      num_voxels_(voxels_per_side_ * voxels_per_side_ * voxels_per_side_) {}
+
+void SSCCriteriaMask::updateFromChangeSet(const voxblox::SSCChangeSet& change_set) {
+  if (change_set.map_reset) {
+    clear();
+  }
+  for (const voxblox::BlockIndex& block_idx : change_set.blocks) {
+    const auto mask_it = change_set.voxel_masks.find(block_idx);
+    const auto block_it = blocks_.find(block_idx);
+    if (mask_it == change_set.voxel_masks.end() || block_it == blocks_.end() ||
+        !ssc_layer_.hasBlock(block_idx)) {
+      updateBlock(block_idx);
+    } else {
+      updateVoxels(block_idx, mask_it->second, &block_it->second);
+    }
+  }
+}
+
+void SSCCriteriaMask::updateFromSSCBlocks(const voxblox::BlockIndexList& ssc_blocks) {
+  for (const voxblox::BlockIndex& block_idx : ssc_blocks) {
+    updateBlock(block_idx);
+  }
+}
+
+void SSCCriteriaMask::rebuild() {
+  clear();
+  voxblox::BlockIndexList blocks;
+  ssc_layer_.getAllAllocatedBlocks(&blocks);
+  updateFromSSCBlocks(blocks);
+}
+
+void SSCCriteriaMask::updateBlock(const voxblox::BlockIndex& block_index) {
+  const voxblox::Block<voxblox::SSCOccupancyVoxel>::ConstPtr ssc_block = ssc_layer_.getBlockPtrByIndex(block_index);
+  if (!ssc_block) {
+    blocks_.erase(block_index);
+    return;
+  }
+
+  BlockMask block_mask((num_voxels_ + 63u) / 64u, 0u);
+  bool any_set = false;
+  for (size_t linear_index = 0u; linear_index < num_voxels_; ++linear_index) {
+    if (criteria_.voxelVerify(ssc_block->getVoxelByLinearIndex(linear_index))) {
+      block_mask[linear_index >> 6] |= uint64_t(1u) << (linear_index & 63u);
+      any_set = true;
+    }
+  }
+
+  if (any_set) {
+    blocks_[block_index] = std::move(block_mask);
+  } else {
+    blocks_.erase(block_index);
+  }
+}
+
+void SSCCriteriaMask::updateVoxels(const voxblox::BlockIndex& block_index, const std::vector<bool>& voxel_mask,
+                                   BlockMask* block_mask) {
+  const voxblox::Block<voxblox::SSCOccupancyVoxel>::ConstPtr ssc_block = ssc_layer_.getBlockPtrByIndex(block_index);
+  for (size_t linear_index = 0u; linear_index < voxel_mask.size() && linear_index < num_voxels_; ++linear_index) {
+    if (!voxel_mask[linear_index]) {
+      continue;
+    }
+    const uint64_t bit = uint64_t(1u) << (linear_index & 63u);
+    if (criteria_.voxelVerify(ssc_block->getVoxelByLinearIndex(linear_index))) {
+      (*block_mask)[linear_index >> 6] |= bit;
+    } else {
+      (*block_mask)[linear_index >> 6] &= ~bit;
+    }
+  }
+
+  for (const uint64_t word : *block_mask) {
+    if (word != 0u) {
+      return;
+    }
+  }
+  blocks_.erase(block_index);
+}
+
+bool SSCCriteriaMask::isSatisfied(const voxblox::GlobalIndex& global_index) const {
+  voxblox::BlockIndex block_idx;
+  voxblox::VoxelIndex voxel_idx;
+  voxblox::getBlockAndVoxelIndexFromGlobalVoxelIndex(global_index, voxels_per_side_, &block_idx, &voxel_idx);
+  const auto it = blocks_.find(block_idx);
+  if (it == blocks_.end()) {
+    return false;
+  }
+  const size_t linear_index = voxel_idx.x() + voxels_per_side_ * (voxel_idx.y() + voxels_per_side_ * voxel_idx.z());
+  return (it->second[linear_index >> 6] >> (linear_index & 63u)) & 1u;
+}
+
+bool SSCCriteriaMask::isSatisfiedAtPosition(const Eigen::Vector3d& position) const {
+  return isSatisfied(voxblox::getGridIndexFromPoint<voxblox::GlobalIndex>(position.cast<voxblox::FloatingPoint>(),
+                                                                          ssc_layer_.voxel_size_inv()));
+}
+
+}  // namespace map
+}  // namespace active_3d_planning
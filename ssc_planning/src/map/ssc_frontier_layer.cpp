@@ -0,0 +1,169 @@
+#include "ssc_planning/map/ssc_frontier_layer.h"
+
+#include <cstdlib>
+
+namespace active_3d_planning {
+namespace map {
+
+SSCFrontierLayer::SSCFrontierLayer(const Config& config, const SSCPlanningStateLayer& state_layer,
+                                   voxblox::FloatingPoint voxel_size)
+    : config_(config),
+      state_layer_(state_layer),
+      voxels_per_side_(state_layer.voxels_per_side()),
+      num_voxels_(voxels_per_side_ * voxels_per_side_ * voxels_per_side_),
+      voxel_size_inv_(1.0f / voxel_size) {
+  for (voxblox::LongIndexElement z = -1; z <= 1; ++z) {
+    for (voxblox::LongIndexElement y = -1; y <= 1; ++y) {
+      for (voxblox::LongIndexElement x = -1; x <= 1; ++x) {
+        const int distance = std::abs(x) + std::abs(y) + std::abs(z);
+        if (distance == 1 || (config_.accurate_frontiers && distance > 1)) {
+          neighbor_offsets_.emplace_back(x, y, z);
+        }
+      }
+    }
+  }
+}
+
+void SSCFrontierLayer::updateFromStateBlocks(const voxblox::BlockIndexList& state_blocks) {
+  const voxblox::LongIndexElement vps = static_cast<voxblox::LongIndexElement>(voxels_per_side_);
+  for (const voxblox::BlockIndex& block_idx : state_blocks) {
+    // the voxels of the block and the ones next to it see its states as neighbors
+    const voxblox::GlobalIndex block_origin = block_idx.cast<voxblox::LongIndexElement>() * vps;
+    updateRegion(voxblox::GlobalIndex(block_origin.array() - 1), voxblox::GlobalIndex(block_origin.array() + vps));
+  }
+}
+
+void SSCFrontierLayer::rebuild() {
+  clear();
+  voxblox::BlockIndexList state_blocks;
+  state_layer_.getAllBlocks(&state_blocks);
+  updateFromStateBlocks(state_blocks);
+}
+
+void SSCFrontierLayer::clear() {
+  blocks_.clear();
+  num_frontier_voxels_ = 0u;
+}
+
+void SSCFrontierLayer::updateRegion(const voxblox::GlobalIndex& min_index, const voxblox::GlobalIndex& max_index) {
+  // states of the region and its one voxel border
+  const voxblox::GlobalIndex states_min(min_index.array() - 1);
+  const voxblox::GlobalIndex states_max(max_index.array() + 1);
+  const voxblox::GlobalIndex states_size = states_max - states_min + voxblox::GlobalIndex::Ones();
+  state_layer_.getStates(states_min, states_max, &states_);
+
+  std::vector<ptrdiff_t> neighbor_steps;
+  neighbor_steps.reserve(neighbor_offsets_.size());
+  for (const voxblox::GlobalIndex& offset : neighbor_offsets_) {
+    neighbor_steps.push_back(offset.x() + states_size.x() * (offset.y() + states_size.y() * offset.z()));
+  }
+
+  // frontier block of the previous voxel, nullptr if it is not allocated
+  voxblox::BlockIndexList touched_blocks;
+  voxblox::BlockIndex block_idx;
+  bool has_block_idx = false;
+  FrontierBlock* block = nullptr;
+  voxblox::GlobalIndex idx;
+  for (idx.z() = min_index.z(); idx.z() <= max_index.z(); ++idx.z()) {
+    for (idx.y() = min_index.y(); idx.y() <= max_index.y(); ++idx.y()) {
+      for (idx.x() = min_index.x(); idx.x() <= max_index.x(); ++idx.x()) {
+        const voxblox::GlobalIndex in_states = idx - states_min;
+        const ptrdiff_t state_index = in_states.x() + states_size.x() * (in_states.y() + states_size.y() * in_states.z());
+        bool frontier = false;
+        if (states_[state_index] == SSCPlanningStateLayer::kUnknown) {
+          for (const ptrdiff_t step : neighbor_steps) {
+            const SSCPlanningStateLayer::State neighbor = states_[state_index + step];
+            if (neighbor == SSCPlanningStateLayer::kFree ||
+                (neighbor == SSCPlanningStateLayer::kOccupied && config_.surface_frontiers)) {
+              frontier = true;
+              break;
+            }
+          }
+        }
+
+        voxblox::BlockIndex voxel_block_idx;
+        voxblox::VoxelIndex voxel_idx;
+        voxblox::getBlockAndVoxelIndexFromGlobalVoxelIndex(idx, voxels_per_side_, &voxel_block_idx, &voxel_idx);
+        if (!has_block_idx || voxel_block_idx != block_idx) {
+          has_block_idx = true;
+          block_idx = voxel_block_idx;
+          const auto it = blocks_.find(block_idx);
+          block = it == blocks_.end() ? nullptr : &it->second;
+          if (block) {
+            touched_blocks.push_back(block_idx);
+          }
+        }
+        if (block == nullptr) {
+          if (!frontier) {
+            continue;
+          }
+          block = &blocks_[block_idx];
+          block->bits.assign((num_voxels_ + 63u) / 64u, 0u);
+          touched_blocks.push_back(block_idx);
+        }
+
+        const size_t linear_index =
+            voxel_idx.x() + voxels_per_side_ * (voxel_idx.y() + voxels_per_side_ * voxel_idx.z());
+        uint64_t& word = block->bits[linear_index >> 6];
+        const uint64_t bit = uint64_t(1u) << (linear_index & 63u);
+        if (frontier && !(word & bit)) {
+          word |= bit;
+          ++block->count;
+          ++num_frontier_voxels_;
+        } else if (!frontier && (word & bit)) {
+          word &= ~bit;
+          --block->count;
+          --num_frontier_voxels_;
+        }
+      }
+    }
+  }
+
+  for (const voxblox::BlockIndex& touched_idx : touched_blocks) {
+    const auto it = blocks_.find(touched_idx);
+    if (it != blocks_.end() && it->second.count == 0u) {
+      blocks_.erase(it);
+    }
+  }
+}
+
+bool SSCFrontierLayer::isFrontier(const voxblox::GlobalIndex& global_index) const {
+  voxblox::BlockIndex block_idx;
+  voxblox::VoxelIndex voxel_idx;
+  voxblox::getBlockAndVoxelIndexFromGlobalVoxelIndex(global_index, voxels_per_side_, &block_idx, &voxel_idx);
+  const auto it = blocks_.find(block_idx);
+  if (it == blocks_.end()) {
+    return false;
+  }
+  const size_t linear_index = voxel_idx.x() + voxels_per_side_ * (voxel_idx.y() + voxels_per_side_ * voxel_idx.z());
+  return (it->second.bits[linear_index >> 6] >> (linear_index & 63u)) & 1u;
+}
+
+bool SSCFrontierLayer::isFrontierAtPosition(const Eigen::Vector3d& position) const {
+  return isFrontier(
+      voxblox::getGridIndexFromPoint<voxblox::GlobalIndex>(position.cast<voxblox::FloatingPoint>(), voxel_size_inv_));
+}
+
+void SSCFrontierLayer::getFrontierVoxels(voxblox::LongIndexVector* frontier_voxels) const {
+  CHECK_NOTNULL(frontier_voxels)->clear();
+  frontier_voxels->reserve(num_frontier_voxels_);
+  for (const auto& block : blocks_) {
+    for (size_t linear_index = 0u; linear_index < num_voxels_; ++linear_index) {
+      const uint64_t word = block.second.bits[linear_index >> 6];
+      if (word == 0u) {
+        linear_index |= 63u;
+        continue;
+      }
+      if ((word >> (linear_index & 63u)) & 1u) {
+        const voxblox::VoxelIndex voxel_idx(linear_index % voxels_per_side_,
+                                            (linear_index / voxels_per_side_) % voxels_per_side_,
+                                            linear_index / (voxels_per_side_ * voxels_per_side_));
+        frontier_voxels->push_back(
+            voxblox::getGlobalVoxelIndexFromBlockAndVoxelIndex(block.first, voxel_idx, voxels_per_side_));
+      }
+    }
+  }
+}
+
+}  // namespace map
+}  // namespace active_3d_planning
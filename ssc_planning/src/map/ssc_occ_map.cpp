@@ -12,7 +12,10 @@ ModuleFactoryRegistry::Registration<SSCOccupancyMap> SSCOccupancyMap::registrati
 
 SSCOccupancyMap::SSCOccupancyMap(PlannerI& planner) : OccupancyMap(planner) {}
 
-voxblox::SSCServer& SSCOccupancyMap::getSSCServer() { return *ssc_server_; }
+voxblox::SSCServer& SSCOccupancyMap::getSSCServer() {
+  CHECK(ssc_server_) << "The ssc map is mirrored from ssc_layer_topic, there is no local server.";
+  return *ssc_server_;
+}
 
 void SSCOccupancyMap::setupFromParamMap(Module::ParamMap* param_map) {
   // create an esdf server
@@ -21,6 +24,7 @@ void SSCOccupancyMap::setupFromParamMap(Module::ParamMap* param_map) {
 
   voxblox::SSCMap::Config map_config;
   ssc_fusion::BaseFusion::Config fusion_config;
+  std::string ssc_layer_topic;
 
   // load ssc map config
   setParam<float>(param_map, "voxel_size", &map_config.ssc_voxel_size, 0.08);
@@ -34,36 +38,93 @@ void SSCOccupancyMap::setupFromParamMap(Module::ParamMap* param_map) {
   setParam<float>(param_map, "max_prob", &fusion_config.max_prob, fusion_config.max_prob);
   setParam<float>(param_map, "decay_weight_std", &fusion_config.decay_weight_std, fusion_config.decay_weight_std);
   setParam<std::string>(param_map, "fusion_strategy", &fusion_config.fusion_strategy, fusion_config.fusion_strategy);
-  ssc_server_.reset(new voxblox::SSCServer(nh, nh_private, fusion_config, map_config));
+  setParam<std::string>(param_map, "ssc_layer_topic", &ssc_layer_topic, ssc_layer_topic);
+  setParam<bool>(param_map, "collision_solid_ball", &collision_solid_ball_, collision_solid_ball_);
+  bool use_ssc_esdf = false;
+  voxblox::SSCEsdfIntegrator::Config esdf_config;
+  setParam<bool>(param_map, "use_ssc_esdf", &use_ssc_esdf, use_ssc_esdf);
+  setParam<float>(param_map, "ssc_esdf_max_distance", &esdf_config.max_distance, esdf_config.max_distance);
+  setParam<float>(param_map, "ssc_esdf_occupied_log_odds", &esdf_config.occupied_log_odds,
+                  esdf_config.occupied_log_odds);
+  if (ssc_layer_topic.empty()) {
+    ssc_server_.reset(new voxblox::SSCServer(nh, nh_private, fusion_config, map_config));
+    ssc_map_ = ssc_server_->getSSCMapPtr();
+  } else {
+    // mirror the map fused by a separate ssc server
+    ssc_layer_client_.reset(new voxblox::SSCLayerClient(nh, map_config, ssc_layer_topic));
+    ssc_map_ = ssc_layer_client_->getSSCMapPtr();
+  }
 
   // cache constants
-  c_voxel_size_ = ssc_server_->getSSCMapPtr()->voxel_size();
-  c_block_size_ = ssc_server_->getSSCMapPtr()->block_size();
+  c_voxel_size_ = ssc_map_->voxel_size();
+  c_block_size_ = ssc_map_->block_size();
+
+  // built once here, the collision radius is fixed, so concurrent isTraversable calls only read it
+  collision_stencil_.update(planner_.getSystemConstraints().collision_radius, c_voxel_size_, collision_solid_ball_);
+
+  if (use_ssc_esdf) {
+    setupSSCEsdf(esdf_config);
+  }
+}
+
+void SSCOccupancyMap::setupSSCEsdf(const voxblox::SSCEsdfIntegrator::Config& config) {
+  ssc_esdf_layer_.reset(new voxblox::Layer<voxblox::SSCEsdfVoxel>(ssc_map_->voxel_size(),
+                                                                  ssc_map_->getSSCLayer().voxels_per_side()));
+  ssc_esdf_integrator_.reset(new voxblox::SSCEsdfIntegrator(config, ssc_map_->getSSCLayer(), ssc_esdf_layer_.get()));
+  ssc_esdf_integrator_->updateFromSSCLayer();
+
+  // only the blocks changed by an integration are propagated
+  auto update_esdf = [this](const voxblox::SSCChangeSet& change_set) {
+    voxblox::SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+    if (change_set.map_reset) {
+      ssc_esdf_integrator_->clear();
+    }
+    ssc_esdf_integrator_->updateFromSSCBlocks(change_set.blocks);
+  };
+  if (ssc_server_) {
+    ssc_server_->addChangeListener(update_esdf);
+  } else {
+    ssc_layer_client_->addChangeListener(update_esdf);
+  }
 }
 
 bool SSCOccupancyMap::isTraversable(const Eigen::Vector3d& position, const Eigen::Quaterniond& orientation) {
     double collision_radius = planner_.getSystemConstraints().collision_radius;
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
 
-    // The criteria to use ssc map is met.
-    std::vector<Eigen::Vector3d> neighbouring_points;
-    voxblox::utils::getSurroundingVoxelsSphere(position, c_voxel_size_, collision_radius, &neighbouring_points);
+    // same reach as the stencil, voxel centers up to collision_radius + voxel size away
+    const double esdf_radius = collision_radius + c_voxel_size_;
+    if (ssc_esdf_integrator_ && esdf_radius < ssc_esdf_integrator_->getConfig().max_distance) {
+        return ssc_esdf_integrator_->getDistanceAtPosition(position.cast<voxblox::FloatingPoint>()) > esdf_radius;
+    }
+    return collision_stencil_.isCollisionFree(*ssc_map_, position);
+}
 
-    for (auto point : neighbouring_points) {
-        if (getVoxelState(point) == OccupancyMap::OCCUPIED) {
-            return false;
-        }
+bool SSCOccupancyMap::isTraversablePath(const std::vector<Eigen::Vector3d>& points) {
+    if (points.empty()) {
+        return true;
+    }
+    double collision_radius = planner_.getSystemConstraints().collision_radius;
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
+
+    const double esdf_radius = collision_radius + c_voxel_size_;
+    if (ssc_esdf_integrator_ && esdf_radius < ssc_esdf_integrator_->getConfig().max_distance) {
+        return collision_stencil_.traversePath(points, [&](const voxblox::GlobalIndex& voxel) {
+            return ssc_esdf_integrator_->getDistance(voxel) > esdf_radius;
+        });
     }
-    return true;
+    return collision_stencil_.isPathCollisionFree(*ssc_map_, points);
 }
 
 bool SSCOccupancyMap::isObserved(const Eigen::Vector3d& point) {
-  return ssc_server_->getSSCMapPtr()->isObserved(point);
+  voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
+  return ssc_map_->isObserved(point);
 }
 
 // get occupancy
 unsigned char SSCOccupancyMap::getVoxelState(const Eigen::Vector3d& point) {
-    auto voxel =
-        ssc_server_->getSSCMapPtr()->getSSCLayerPtr()->getVoxelPtrByCoordinates(point.cast<voxblox::FloatingPoint>());
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
+    auto voxel = ssc_map_->getVoxelPtrByCoordinates(point);
 
     if (voxel == nullptr) 
       return OccupancyMap::UNKNOWN;
@@ -85,8 +146,7 @@ double SSCOccupancyMap::getVoxelSize() { return c_voxel_size_; }
 // get the center of a voxel from input point
 bool SSCOccupancyMap::getVoxelCenter(Eigen::Vector3d* center,
                                 const Eigen::Vector3d& point) {
-  voxblox::BlockIndex block_id = ssc_server_->getSSCMapPtr()
-                                     ->getSSCLayerPtr()
+  voxblox::BlockIndex block_id = ssc_map_->getSSCLayerPtr()
                                      ->computeBlockIndexFromCoordinates(
                                          point.cast<voxblox::FloatingPoint>());
   *center = voxblox::getOriginPointFromGridIndex(block_id, c_block_size_)
@@ -0,0 +1,253 @@
+#include "ssc_planning/map/ssc_planning_state_layer.h"
+
+#include <cmath>
+#include <utility>
+
+namespace active_3d_planning {
+namespace map {
+
+void insertOverlappingBlocks(const voxblox::BlockIndex& other_block_index, size_t other_voxels_per_side,
+                             size_t voxels_per_side, voxblox::IndexSet* blocks) {
+  CHECK_NOTNULL(blocks);
+  const voxblox::LongIndexElement other_vps = static_cast<voxblox::LongIndexElement>(other_voxels_per_side);
+  const voxblox::FloatingPoint vps_inv = 1.0f / voxels_per_side;
+  const voxblox::GlobalIndex first_voxel = other_block_index.cast<voxblox::LongIndexElement>() * other_vps;
+  const voxblox::BlockIndex min_block = voxblox::getBlockIndexFromGlobalVoxelIndex(first_voxel, vps_inv);
+  const voxblox::BlockIndex max_block = voxblox::getBlockIndexFromGlobalVoxelIndex(
+      voxblox::GlobalIndex(first_voxel.array() + (other_vps - 1)), vps_inv);
+  voxblox::BlockIndex block_idx;
+  for (block_idx.z() = min_block.z(); block_idx.z() <= max_block.z(); ++block_idx.z()) {
+    for (block_idx.y() = min_block.y(); block_idx.y() <= max_block.y(); ++block_idx.y()) {
+      for (block_idx.x() = min_block.x(); block_idx.x() <= max_block.x(); ++block_idx.x()) {
+        blocks->insert(block_idx);
+      }
+    }
+  }
+}
+
+SSCPlanningStateLayer::SSCPlanningStateLayer(const Config& config,
+                                             const voxblox::Layer<voxblox::SSCOccupancyVoxel>& ssc_layer,
+                                             voxblox::Layer<voxblox::EsdfVoxel>* esdf_layer)
+    : config_(config),
+      ssc_layer_(ssc_layer),
+      esdf_layer_(CHECK_NOTNULL(esdf_layer)),
+      voxels_per_side_(ssc_layer.voxels_per_side()),
+      esdf_voxels_per_side_(esdf_layer->voxels_per_side()),
+      num_voxels_(voxels_per_side_ * voxels_per_side_ * voxels_per_side_),
+      occupied_distance_(config.occupied_distance > 0.0f ? config.occupied_distance : ssc_layer.voxel_size()) {
+  CHECK_LT(std::abs(esdf_layer_->voxel_size() - ssc_layer.voxel_size()), 1e-6f)
+      << "The esdf and ssc layers need the same voxel size.";
+}
+
+void SSCPlanningStateLayer::updateFromSSCBlocks(const voxblox::BlockIndexList& ssc_blocks,
+                                                voxblox::BlockIndexList* changed_blocks) {
+  for (const voxblox::BlockIndex& block_idx : ssc_blocks) {
+    if (updateBlock(block_idx) && changed_blocks) {
+      changed_blocks->push_back(block_idx);
+    }
+  }
+}
+
+void SSCPlanningStateLayer::updateFromEsdfLayer(voxblox::BlockIndexList* changed_blocks) {
+  voxblox::BlockIndexList esdf_blocks;
+  esdf_layer_->getAllUpdatedBlocks(voxblox::Update::kEsdf, &esdf_blocks);
+  for (const voxblox::BlockIndex& block_idx : esdf_blocks) {
+    esdf_layer_->getBlockPtrByIndex(block_idx)->setUpdated(voxblox::Update::kEsdf, false);
+  }
+  updateFromEsdfBlocks(esdf_blocks, changed_blocks);
+}
+
+void SSCPlanningStateLayer::updateFromEsdfBlocks(const voxblox::BlockIndexList& esdf_blocks,
+                                                 voxblox::BlockIndexList* changed_blocks) {
+  if (esdf_voxels_per_side_ == voxels_per_side_) {
+    updateFromSSCBlocks(esdf_blocks, changed_blocks);
+    return;
+  }
+
+  // state blocks overlapped by the esdf blocks, each recomputed once
+  voxblox::IndexSet state_blocks;
+  for (const voxblox::BlockIndex& esdf_block_idx : esdf_blocks) {
+    insertOverlappingBlocks(esdf_block_idx, esdf_voxels_per_side_, voxels_per_side_, &state_blocks);
+  }
+  for (const voxblox::BlockIndex& block_idx : state_blocks) {
+    if (updateBlock(block_idx) && changed_blocks) {
+      changed_blocks->push_back(block_idx);
+    }
+  }
+}
+
+void SSCPlanningStateLayer::rebuild() {
+  clear();
+  voxblox::BlockIndexList blocks;
+  ssc_layer_.getAllAllocatedBlocks(&blocks);
+  updateFromSSCBlocks(blocks);
+  esdf_layer_->getAllAllocatedBlocks(&blocks);
+  for (const voxblox::BlockIndex& block_idx : blocks) {
+    esdf_layer_->getBlockPtrByIndex(block_idx)->setUpdated(voxblox::Update::kEsdf, false);
+  }
+  updateFromEsdfBlocks(blocks);
+}
+
+SSCPlanningStateLayer::State SSCPlanningStateLayer::computeState(const voxblox::EsdfVoxel* esdf_voxel,
+                                                                 const voxblox::SSCOccupancyVoxel* ssc_voxel,
+                                                                 bool* predicted) const {
+  if (ssc_voxel != nullptr && (config_.confident_criteria ? config_.confident_criteria(*ssc_voxel)
+                                                           : ssc_voxel->probability_log > config_.confident_log_odds)) {
+    *predicted = true;
+    return kOccupied;
+  }
+  if (config_.use_measured && esdf_voxel != nullptr && esdf_voxel->observed) {
+    *predicted = false;
+    return esdf_voxel->distance < occupied_distance_ ? kOccupied : kFree;
+  }
+  *predicted = true;
+  if (config_.use_predicted && ssc_voxel != nullptr && ssc_voxel->observed) {
+    return ssc_voxel->probability_log > config_.occupied_log_odds ? kOccupied : kFree;
+  }
+  return kUnknown;
+}
+
+bool SSCPlanningStateLayer::updateBlock(const voxblox::BlockIndex& block_index) {
+  typedef voxblox::Block<voxblox::EsdfVoxel> EsdfBlock;
+  const voxblox::Block<voxblox::SSCOccupancyVoxel>::ConstPtr ssc_block = ssc_layer_.getBlockPtrByIndex(block_index);
+
+  // the esdf block of the previous voxel, only changes if the layers use different block sizes
+  voxblox::BlockIndex esdf_block_idx = block_index;
+  EsdfBlock::ConstPtr esdf_block = esdf_layer_->getBlockPtrByIndex(block_index);
+  const bool same_blocks = esdf_voxels_per_side_ == voxels_per_side_;
+  if (!ssc_block && !esdf_block && same_blocks) {
+    return blocks_.erase(block_index) > 0u;
+  }
+
+  PackedBlock block;
+  block.states.assign((num_voxels_ + 31u) / 32u, 0u);
+  block.predicted.assign((num_voxels_ + 63u) / 64u, 0u);
+  bool any_known = false;
+  voxblox::VoxelIndex voxel_idx;
+  size_t linear_index = 0u;
+  for (voxel_idx.z() = 0; voxel_idx.z() < static_cast<voxblox::IndexElement>(voxels_per_side_); ++voxel_idx.z()) {
+    for (voxel_idx.y() = 0; voxel_idx.y() < static_cast<voxblox::IndexElement>(voxels_per_side_); ++voxel_idx.y()) {
+      for (voxel_idx.x() = 0; voxel_idx.x() < static_cast<voxblox::IndexElement>(voxels_per_side_);
+           ++voxel_idx.x(), ++linear_index) {
+        const voxblox::EsdfVoxel* esdf_voxel = nullptr;
+        if (same_blocks) {
+          esdf_voxel = esdf_block ? &esdf_block->getVoxelByVoxelIndex(voxel_idx) : nullptr;
+        } else {
+          const voxblox::GlobalIndex global_idx =
+              voxblox::getGlobalVoxelIndexFromBlockAndVoxelIndex(block_index, voxel_idx, voxels_per_side_);
+          voxblox::BlockIndex idx;
+          voxblox::VoxelIndex esdf_voxel_idx;
+          voxblox::getBlockAndVoxelIndexFromGlobalVoxelIndex(global_idx, esdf_voxels_per_side_, &idx,
+                                                             &esdf_voxel_idx);
+          if (idx != esdf_block_idx) {
+            esdf_block_idx = idx;
+            esdf_block = esdf_layer_->getBlockPtrByIndex(idx);
+          }
+          esdf_voxel = esdf_block ? &esdf_block->getVoxelByVoxelIndex(esdf_voxel_idx) : nullptr;
+        }
+        const voxblox::SSCOccupancyVoxel* ssc_voxel =
+            ssc_block ? &ssc_block->getVoxelByLinearIndex(linear_index) : nullptr;
+
+        bool predicted = false;
+        const State state = computeState(esdf_voxel, ssc_voxel, &predicted);
+        if (state == kUnknown) {
+          continue;
+        }
+        any_known = true;
+        block.states[linear_index >> 5] |= static_cast<uint64_t>(state) << ((linear_index & 31u) << 1);
+        if (predicted) {
+          block.predicted[linear_index >> 6] |= uint64_t(1u) << (linear_index & 63u);
+        }
+      }
+    }
+  }
+
+  if (!any_known) {
+    return blocks_.erase(block_index) > 0u;
+  }
+  const auto it = blocks_.find(block_index);
+  if (it == blocks_.end()) {
+    blocks_.emplace(block_index, std::move(block));
+  } else if (it->second.states != block.states || it->second.predicted != block.predicted) {
+    it->second = std::move(block);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void SSCPlanningStateLayer::getAllBlocks(voxblox::BlockIndexList* blocks) const {
+  CHECK_NOTNULL(blocks)->clear();
+  blocks->reserve(blocks_.size());
+  for (const auto& block : blocks_) {
+    blocks->push_back(block.first);
+  }
+}
+
+SSCPlanningStateLayer::State SSCPlanningStateLayer::getState(const voxblox::GlobalIndex& global_index,
+                                                             bool* predicted) const {
+  voxblox::BlockIndex block_idx;
+  voxblox::VoxelIndex voxel_idx;
+  voxblox::getBlockAndVoxelIndexFromGlobalVoxelIndex(global_index, voxels_per_side_, &block_idx, &voxel_idx);
+  const auto it = blocks_.find(block_idx);
+  if (it == blocks_.end()) {
+    if (predicted) {
+      *predicted = false;
+    }
+    return kUnknown;
+  }
+  const size_t linear_index = voxel_idx.x() + voxels_per_side_ * (voxel_idx.y() + voxels_per_side_ * voxel_idx.z());
+  if (predicted) {
+    *predicted = (it->second.predicted[linear_index >> 6] >> (linear_index & 63u)) & 1u;
+  }
+  return static_cast<State>((it->second.states[linear_index >> 5] >> ((linear_index & 31u) << 1)) & 3u);
+}
+
+SSCPlanningStateLayer::State SSCPlanningStateLayer::getStateAtPosition(const Eigen::Vector3d& position,
+                                                                       bool* predicted) const {
+  return getState(voxblox::getGridIndexFromPoint<voxblox::GlobalIndex>(position.cast<voxblox::FloatingPoint>(),
+                                                                       ssc_layer_.voxel_size_inv()),
+                  predicted);
+}
+
+void SSCPlanningStateLayer::getStates(const voxblox::GlobalIndex& min_index, const voxblox::GlobalIndex& max_index,
+                                      std::vector<State>* states) const {
+  CHECK_NOTNULL(states);
+  const voxblox::GlobalIndex size = max_index - min_index + voxblox::GlobalIndex::Ones();
+  states->assign(size.x() * size.y() * size.z(), kUnknown);
+
+  const voxblox::LongIndexElement vps = static_cast<voxblox::LongIndexElement>(voxels_per_side_);
+  const voxblox::FloatingPoint vps_inv = 1.0f / voxels_per_side_;
+  const voxblox::BlockIndex min_block = voxblox::getBlockIndexFromGlobalVoxelIndex(min_index, vps_inv);
+  const voxblox::BlockIndex max_block = voxblox::getBlockIndexFromGlobalVoxelIndex(max_index, vps_inv);
+  voxblox::BlockIndex block_idx;
+  for (block_idx.z() = min_block.z(); block_idx.z() <= max_block.z(); ++block_idx.z()) {
+    for (block_idx.y() = min_block.y(); block_idx.y() <= max_block.y(); ++block_idx.y()) {
+      for (block_idx.x() = min_block.x(); block_idx.x() <= max_block.x(); ++block_idx.x()) {
+        const auto it = blocks_.find(block_idx);
+        if (it == blocks_.end()) {
+          continue;
+        }
+        // part of the box inside this block
+        const voxblox::GlobalIndex block_origin = block_idx.cast<voxblox::LongIndexElement>() * vps;
+        const voxblox::GlobalIndex first = min_index.cwiseMax(block_origin);
+        const voxblox::GlobalIndex last = max_index.cwiseMin(voxblox::GlobalIndex(block_origin.array() + (vps - 1)));
+        voxblox::GlobalIndex idx;
+        for (idx.z() = first.z(); idx.z() <= last.z(); ++idx.z()) {
+          for (idx.y() = first.y(); idx.y() <= last.y(); ++idx.y()) {
+            for (idx.x() = first.x(); idx.x() <= last.x(); ++idx.x()) {
+              const voxblox::GlobalIndex local = idx - block_origin;
+              const size_t linear_index = local.x() + vps * (local.y() + vps * local.z());
+              const voxblox::GlobalIndex in_box = idx - min_index;
+              (*states)[in_box.x() + size.x() * (in_box.y() + size.y() * in_box.z())] = static_cast<State>(
+                  (it->second.states[linear_index >> 5] >> ((linear_index & 31u) << 1)) & 3u);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace map
+}  // namespace active_3d_planning
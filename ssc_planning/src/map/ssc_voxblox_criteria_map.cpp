@@ -1,7 +1,9 @@
 #include "ssc_planning/map/ssc_voxblox_criteria_map.h"
+#include <sstream>
 #include <voxblox/core/common.h>
 #include <voxblox_ros/ros_params.h>
 #include <active_3d_planning_core/data/system_constraints.h>
+#include <ssc_mapping/utils/parallel.h>
 
 namespace active_3d_planning {
 namespace map {
@@ -18,10 +20,14 @@ void SSCVoxbloxCriteriaMap::setupFromParamMap(Module::ParamMap* param_map) {
 
     voxblox::SSCMap::Config map_config;
     ssc_fusion::BaseFusion::Config fusion_config;
+    std::string ssc_layer_topic;
     
     // ssc criteria params
     std::string ssc_criteria("confidence");
     float ssc_criteria_threshold = 0.92f;
+    std::string ssc_criteria_labels;
+    float ssc_criteria_min_weight = 0.0f;
+    bool use_criteria_mask = true;
 
     // load ssc map config
     setParam<float>(param_map, "voxel_size", &map_config.ssc_voxel_size, map_config.ssc_voxel_size);
@@ -35,11 +41,34 @@ void SSCVoxbloxCriteriaMap::setupFromParamMap(Module::ParamMap* param_map) {
     setParam<float>(param_map, "max_prob", &fusion_config.max_prob, fusion_config.max_prob);
     setParam<float>(param_map, "decay_weight_std", &fusion_config.decay_weight_std, fusion_config.decay_weight_std);
     setParam<std::string>(param_map, "fusion_strategy", &fusion_config.fusion_strategy, fusion_config.fusion_strategy);
+    setParam<std::string>(param_map, "ssc_layer_topic", &ssc_layer_topic, ssc_layer_topic);
     setParam<std::string>(param_map, "ssc_criteria", &ssc_criteria, ssc_criteria);
     setParam<float>(param_map, "criteria_threshold", &ssc_criteria_threshold, ssc_criteria_threshold);
+    setParam<std::string>(param_map, "criteria_labels", &ssc_criteria_labels, ssc_criteria_labels);
+    setParam<float>(param_map, "criteria_min_weight", &ssc_criteria_min_weight, ssc_criteria_min_weight);
+    setParam<bool>(param_map, "use_criteria_mask", &use_criteria_mask, use_criteria_mask);
+    setParam<bool>(param_map, "collision_solid_ball", &collision_solid_ball_, collision_solid_ball_);
+    bool use_state_layer = false;
+    double state_layer_update_period = 0.1;
+    setParam<bool>(param_map, "use_state_layer", &use_state_layer, use_state_layer);
+    setParam<double>(param_map, "state_layer_update_period", &state_layer_update_period, state_layer_update_period);
+    bool use_frontier_layer = false;
+    SSCFrontierLayer::Config frontier_config;
+    setParam<bool>(param_map, "use_frontier_layer", &use_frontier_layer, use_frontier_layer);
+    setParam<bool>(param_map, "accurate_frontiers", &frontier_config.accurate_frontiers,
+                   frontier_config.accurate_frontiers);
+    setParam<bool>(param_map, "surface_frontiers", &frontier_config.surface_frontiers,
+                   frontier_config.surface_frontiers);
 
     // setup ssc server
-    ssc_server_.reset(new voxblox::SSCServer(nh, nh_private, fusion_config, map_config));
+    if (ssc_layer_topic.empty()) {
+        ssc_server_.reset(new voxblox::SSCServer(nh, nh_private, fusion_config, map_config));
+        ssc_map_ = ssc_server_->getSSCMapPtr();
+    } else {
+        // mirror the map fused by a separate ssc server
+        ssc_layer_client_.reset(new voxblox::SSCLayerClient(nh, map_config, ssc_layer_topic));
+        ssc_map_ = ssc_layer_client_->getSSCMapPtr();
+    }
 
     // setup esdf server
     auto esdf_config = voxblox::getEsdfMapConfigFromRosParam(nh_private);
@@ -52,24 +81,96 @@ void SSCVoxbloxCriteriaMap::setupFromParamMap(Module::ParamMap* param_map) {
     setParam<float>(param_map, "voxel_size", &tsdf_config.tsdf_voxel_size, tsdf_config.tsdf_voxel_size);
 
     // setup ESDF Server
-    esdf_server_.reset(new voxblox::EsdfServer(nh, nh_private, esdf_config, esdf_integrator_config, tsdf_config,
-                                               tsdf_integrator_config, mesh_config));
+    esdf_server_.reset(new voxblox::EsdfServer(getEsdfNodeHandle(nh), getEsdfNodeHandle(nh_private), esdf_config,
+                                               esdf_integrator_config, tsdf_config, tsdf_integrator_config,
+                                               mesh_config));
     esdf_server_->setTraversabilityRadius(planner_.getSystemConstraints().collision_radius);
-
-    //setup criteria for ssc
-    if (ssc_criteria.compare(ssc_utilization_criterias::confidence) == 0) {
-        ssc_utilization_criteria_.reset(new ConfidenceCriteria(ssc_criteria_threshold));
-    } else {
-        LOG(WARNING) << "Wrong Criteria provided. Using default confidence criteria";
-        ssc_utilization_criteria_.reset(new ConfidenceCriteria(ssc_criteria_threshold));
+    setupEsdfCallbacks();
+
+    //setup criteria for ssc, a comma separated list of criterias that all have to be met
+    std::unique_ptr<AllCriteria> criterias(new AllCriteria());
+    std::stringstream criteria_names(ssc_criteria);
+    std::string criteria_name;
+    while (std::getline(criteria_names, criteria_name, ',')) {
+        if (criteria_name.compare(ssc_utilization_criterias::confidence) == 0) {
+            criterias->addCriteria(std::unique_ptr<BaseCriteria>(new ConfidenceCriteria(ssc_criteria_threshold)));
+        } else if (criteria_name.compare(ssc_utilization_criterias::label) == 0) {
+            // labels as comma separated list, e.g. "1,2,5"
+            std::vector<int> labels;
+            std::stringstream label_names(ssc_criteria_labels);
+            std::string label;
+            while (std::getline(label_names, label, ',')) {
+                std::stringstream label_stream(label);
+                int label_id = 0;
+                if (!(label_stream >> label_id) || !(label_stream >> std::ws).eof()) {
+                    LOG(WARNING) << "Invalid label '" << label << "' in criteria_labels, ignoring it.";
+                    continue;
+                }
+                labels.push_back(label_id);
+            }
+            if (labels.empty()) {
+                // would never be met
+                LOG(WARNING) << "Label Criteria without valid criteria_labels provided, ignoring it.";
+                continue;
+            }
+            criterias->addCriteria(std::unique_ptr<BaseCriteria>(new LabelCriteria(labels)));
+        } else if (criteria_name.compare(ssc_utilization_criterias::weight) == 0) {
+            criterias->addCriteria(std::unique_ptr<BaseCriteria>(new WeightCriteria(ssc_criteria_min_weight)));
+        } else {
+            LOG(WARNING) << "Wrong Criteria '" << criteria_name << "' provided, ignoring it.";
+        }
+    }
+    if (criterias->empty()) {
+        LOG(WARNING) << "No valid Criteria provided. Using default confidence criteria";
+        criterias->addCriteria(std::unique_ptr<BaseCriteria>(new ConfidenceCriteria(ssc_criteria_threshold)));
+    }
+    ssc_utilization_criteria_ = std::move(criterias);
+
+    if (use_criteria_mask) {
+        // evaluated for the fused voxels as their blocks are committed
+        criteria_mask_.reset(new SSCCriteriaMask(*ssc_utilization_criteria_, ssc_map_->getSSCLayer()));
+        criteria_mask_->rebuild();
+        auto update_mask = [this](const voxblox::SSCChangeSet& change_set) {
+            voxblox::SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+            criteria_mask_->updateFromChangeSet(change_set);
+        };
+        if (ssc_server_) {
+            ssc_server_->addChangeListener(update_mask);
+        } else {
+            ssc_layer_client_->addChangeListener(update_mask);
+        }
     }
 
     // cache constants
-    c_voxel_size_ = ssc_server_->getSSCMapPtr()->voxel_size();
-    c_block_size_ = ssc_server_->getSSCMapPtr()->block_size();
+    c_voxel_size_ = ssc_map_->voxel_size();
+    c_block_size_ = ssc_map_->block_size();
+
+    // built once here, the collision radius is fixed, so concurrent isTraversable calls only read it
+    collision_stencil_.update(planner_.getSystemConstraints().collision_radius, c_voxel_size_, collision_solid_ball_);
+
+    // the frontiers are computed from the state layer
+    if (use_state_layer || use_frontier_layer) {
+        // confident ssc voxels are occupied, everything else comes from the measured map
+        SSCPlanningStateLayer::Config state_config;
+        state_config.use_measured = true;
+        state_config.use_predicted = false;
+        state_config.occupied_distance = c_voxel_size_;
+        const BaseCriteria* criteria = ssc_utilization_criteria_.get();
+        state_config.confident_criteria = [criteria](const voxblox::SSCOccupancyVoxel& voxel) {
+            return criteria->voxelVerify(voxel);
+        };
+        setupStateLayer(state_config);
+    }
+    if (use_frontier_layer) {
+        setupFrontierLayer(frontier_config);
+    }
+
+    // after the layers derived from the ssc map, so their listeners run first and
+    // a reader never sees a new version with outdated layers
+    setupBlockVersions(state_layer_update_period);
 }
 
-bool SSCVoxbloxCriteriaMap::isTraversable(const Eigen::Vector3d& position, const Eigen::Quaterniond& orientation) {
+bool SSCVoxbloxCriteriaMap::isTraversableAt(const Eigen::Vector3d& position, SSCVisitedVoxels* visited) {
     double collision_radius = planner_.getSystemConstraints().collision_radius;
 
     // the criteria to use ssc map is not met. Using measured map instead
@@ -77,27 +178,23 @@ bool SSCVoxbloxCriteriaMap::isTraversable(const Eigen::Vector3d& position, const
     if (esdf_server_->getEsdfMapPtr()->getDistanceAtPosition(position, &distance)) {
         // This means the voxel is observed
         return (distance > collision_radius);
-    } else if (ssc_utilization_criteria_->criteriaVerify(*ssc_server_->getSSCMapPtr(), position)) {
+    } else if (criteriaVerify(position)) {
         // The criteria to use ssc map is met.
-        std::vector<Eigen::Vector3d> neighbouring_points;
-        voxblox::utils::getSurroundingVoxelsSphere(position, c_voxel_size_, collision_radius, &neighbouring_points);
-
-        for (auto point : neighbouring_points) {
-            if (getVoxelState(point) == OccupancyMap::OCCUPIED) {
-                return false;
-            }
-        }
-        return true;
+        return collision_stencil_.isCollisionFree(
+            collision_stencil_.getGlobalIndex(position),
+            [this](const Eigen::Vector3d& point) { return computeVoxelState(point) == OccupancyMap::OCCUPIED; },
+            visited);
     }
 
     return false;
 }
 
 bool SSCVoxbloxCriteriaMap::isObserved(const Eigen::Vector3d& point) {
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
     bool observed = false;
 
-    if (ssc_utilization_criteria_->criteriaVerify(*ssc_server_->getSSCMapPtr(), point)) {
-        observed = ssc_server_->getSSCMapPtr()->isObserved(point);
+    if (criteriaVerify(point)) {
+        observed = ssc_map_->isObserved(point);
     } else {
         observed = esdf_server_->getEsdfMapPtr()->isObserved(point);
     }
@@ -105,9 +202,11 @@ bool SSCVoxbloxCriteriaMap::isObserved(const Eigen::Vector3d& point) {
 }
 
 // get occupancy
-unsigned char SSCVoxbloxCriteriaMap::getVoxelState(const Eigen::Vector3d& point) {
-    
-    if (ssc_utilization_criteria_->criteriaVerify(*ssc_server_->getSSCMapPtr(), point)) {
+unsigned char SSCVoxbloxCriteriaMap::computeVoxelState(const Eigen::Vector3d& point) {
+    if (state_layer_) {
+        return getStateLayerVoxelState(point);
+    }
+    if (criteriaVerify(point)) {
         return OccupancyMap::OCCUPIED;
     } else {
         double distance = 0.0;
@@ -123,16 +222,31 @@ unsigned char SSCVoxbloxCriteriaMap::getVoxelState(const Eigen::Vector3d& point)
     return OccupancyMap::UNKNOWN;
 }
 
+void SSCVoxbloxCriteriaMap::computeQueryStates(const std::vector<Eigen::Vector3d>& points,
+                                               std::vector<VoxelQuery>* queries, size_t num_threads) {
+    if (state_layer_) {
+        SSCVoxbloxOccupancyMap::computeQueryStates(points, queries, num_threads);
+        return;
+    }
+    voxblox::parallelForRanges(points.size(), num_threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            VoxelQuery& query = (*queries)[i];
+            if (criteriaVerify(points[i])) {
+                query.state = OccupancyMap::OCCUPIED;
+            } else if (query.observed) {
+                query.state = query.measured_state;
+            } else {
+                query.state = OccupancyMap::UNKNOWN;
+            }
+        }
+    });
+}
 
-// criteria functions
-bool ConfidenceCriteria::criteriaVerify(const voxblox::SSCMap & ssc_map, const Eigen::Vector3d& position) {
-   // Get the block.
-    auto block_ptr = ssc_map.getSSCLayer().getBlockPtrByCoordinates(position.cast<float>());
-    if (block_ptr) {
-        const auto& voxel = block_ptr->getVoxelByCoordinates(position.cast<float>());
-        return voxel.probability_log > voxblox::logOddsFromProbability(confidence_threshold_);
+bool SSCVoxbloxCriteriaMap::criteriaVerify(const Eigen::Vector3d& point) const {
+    if (criteria_mask_) {
+        return criteria_mask_->isSatisfiedAtPosition(point);
     }
-    return false;
+    return ssc_utilization_criteria_->criteriaVerify(*ssc_map_, point);
 }
 
 }  // namespace map
@@ -1,18 +1,77 @@
 #include "ssc_planning/map/ssc_voxblox_map.h"
 
+#include <algorithm>
+#include <tuple>
+
 #include <voxblox/core/common.h>
 #include <voxblox_ros/ros_params.h>
 #include <active_3d_planning_core/data/system_constraints.h>
+#include <ssc_mapping/utils/block_index_math.h>
+#include <ssc_mapping/utils/parallel.h>
 
 namespace active_3d_planning {
 namespace map {
 
+namespace {
+
+struct PointInBlock {
+    voxblox::BlockIndex block_index;
+    size_t linear_index;
+    size_t point_index;
+
+    bool operator<(const PointInBlock& other) const {
+        return std::tie(block_index.x(), block_index.y(), block_index.z(), linear_index) <
+               std::tie(other.block_index.x(), other.block_index.y(), other.block_index.z(), other.linear_index);
+    }
+};
+
+// Calls fn(point_index, voxel) for every point, voxel is nullptr if its block
+// is not allocated or skip_block(block_index) is true. Points in the same
+// block share one block lookup.
+template <typename VoxelType, typename Function, typename SkipFunction>
+void visitPointsByBlock(const voxblox::Layer<VoxelType>& layer, const std::vector<Eigen::Vector3d>& points,
+                        size_t num_threads, const Function& fn, const SkipFunction& skip_block) {
+    std::vector<PointInBlock> entries(points.size());
+    voxblox::dispatchBlockIndexMath(layer.voxels_per_side(), [&](const auto& math) {
+        for (size_t i = 0u; i < points.size(); ++i) {
+            const voxblox::GlobalIndex global_idx = voxblox::getGridIndexFromPoint<voxblox::GlobalIndex>(
+                points[i].cast<voxblox::FloatingPoint>(), layer.voxel_size_inv());
+            entries[i].block_index = math.computeBlockIndex(global_idx);
+            entries[i].linear_index = math.computeLinearIndex(global_idx);
+            entries[i].point_index = i;
+        }
+    });
+    std::sort(entries.begin(), entries.end());
+
+    voxblox::parallelForRanges(entries.size(), num_threads, [&](size_t begin, size_t end) {
+        typename voxblox::Block<VoxelType>::ConstPtr block;
+        for (size_t i = begin; i < end; ++i) {
+            if (i == begin || entries[i].block_index != entries[i - 1].block_index) {
+                block = skip_block(entries[i].block_index) ? nullptr : layer.getBlockPtrByIndex(entries[i].block_index);
+            }
+            fn(entries[i].point_index, block ? &block->getVoxelByLinearIndex(entries[i].linear_index) : nullptr);
+        }
+    });
+}
+
+template <typename VoxelType, typename Function>
+void visitPointsByBlock(const voxblox::Layer<VoxelType>& layer, const std::vector<Eigen::Vector3d>& points,
+                        size_t num_threads, const Function& fn) {
+    visitPointsByBlock(layer, points, num_threads, fn,
+                       [](const voxblox::BlockIndex& /*block_index*/) { return false; });
+}
+
+}  // namespace
+
 ModuleFactoryRegistry::Registration<SSCVoxbloxOccupancyMap> SSCVoxbloxOccupancyMap::registration(
     "SSCVoxbloxOccupancyMap");
 
 SSCVoxbloxOccupancyMap::SSCVoxbloxOccupancyMap(PlannerI& planner) : OccupancyMap(planner) {}
 
-voxblox::SSCServer& SSCVoxbloxOccupancyMap::getSSCServer() { return *ssc_server_; }
+voxblox::SSCServer& SSCVoxbloxOccupancyMap::getSSCServer() {
+    CHECK(ssc_server_) << "The ssc map is mirrored from ssc_layer_topic, there is no local server.";
+    return *ssc_server_;
+}
 
 
 voxblox::EsdfServer& SSCVoxbloxOccupancyMap::getESDFServer() { return *esdf_server_; }
@@ -24,6 +83,7 @@ void SSCVoxbloxOccupancyMap::setupFromParamMap(Module::ParamMap* param_map) {
 
     voxblox::SSCMap::Config map_config;
     ssc_fusion::BaseFusion::Config fusion_config;
+    std::string ssc_layer_topic;
 
     // load ssc map config
     setParam<float>(param_map, "voxel_size", &map_config.ssc_voxel_size, map_config.ssc_voxel_size);
@@ -37,13 +97,39 @@ void SSCVoxbloxOccupancyMap::setupFromParamMap(Module::ParamMap* param_map) {
     setParam<float>(param_map, "max_prob", &fusion_config.max_prob, fusion_config.max_prob);
     setParam<float>(param_map, "decay_weight_std", &fusion_config.decay_weight_std, fusion_config.decay_weight_std);
     setParam<std::string>(param_map, "fusion_strategy", &fusion_config.fusion_strategy, fusion_config.fusion_strategy);
+    setParam<std::string>(param_map, "ssc_layer_topic", &ssc_layer_topic, ssc_layer_topic);
     setParam<bool>(param_map, "use_ssc_planning", &use_ssc_planning_, false);
     setParam<bool>(param_map, "use_ssc_information_planning", &use_ssc_information_planning_, true);
     setParam<bool>(param_map, "use_voxblox_planning", &use_voxblox_planning_, true);
     setParam<bool>(param_map, "use_voxblox_information_planning", &use_voxblox_information_planning_, true);
+    setParam<bool>(param_map, "collision_solid_ball", &collision_solid_ball_, collision_solid_ball_);
+    bool use_ssc_esdf = false;
+    voxblox::SSCEsdfIntegrator::Config esdf_config;
+    setParam<bool>(param_map, "use_ssc_esdf", &use_ssc_esdf, use_ssc_esdf);
+    setParam<float>(param_map, "ssc_esdf_max_distance", &esdf_config.max_distance, esdf_config.max_distance);
+    setParam<float>(param_map, "ssc_esdf_occupied_log_odds", &esdf_config.occupied_log_odds,
+                    esdf_config.occupied_log_odds);
+    bool use_state_layer = false;
+    double state_layer_update_period = 0.1;
+    setParam<bool>(param_map, "use_state_layer", &use_state_layer, use_state_layer);
+    setParam<double>(param_map, "state_layer_update_period", &state_layer_update_period, state_layer_update_period);
+    bool use_frontier_layer = false;
+    SSCFrontierLayer::Config frontier_config;
+    setParam<bool>(param_map, "use_frontier_layer", &use_frontier_layer, use_frontier_layer);
+    setParam<bool>(param_map, "accurate_frontiers", &frontier_config.accurate_frontiers,
+                   frontier_config.accurate_frontiers);
+    setParam<bool>(param_map, "surface_frontiers", &frontier_config.surface_frontiers,
+                   frontier_config.surface_frontiers);
 
     // setup ssc server
-    ssc_server_.reset(new voxblox::SSCServer(nh, nh_private, fusion_config, map_config));
+    if (ssc_layer_topic.empty()) {
+        ssc_server_.reset(new voxblox::SSCServer(nh, nh_private, fusion_config, map_config));
+        ssc_map_ = ssc_server_->getSSCMapPtr();
+    } else {
+        // mirror the map fused by a separate ssc server
+        ssc_layer_client_.reset(new voxblox::SSCLayerClient(nh, map_config, ssc_layer_topic));
+        ssc_map_ = ssc_layer_client_->getSSCMapPtr();
+    }
 
     // setup esdf server
     auto esdf_config = voxblox::getEsdfMapConfigFromRosParam(nh_private);
@@ -56,16 +142,265 @@ void SSCVoxbloxOccupancyMap::setupFromParamMap(Module::ParamMap* param_map) {
     setParam<float>(param_map, "voxel_size", &tsdf_config.tsdf_voxel_size, tsdf_config.tsdf_voxel_size);
 
     // setup ESDF Server
-    esdf_server_.reset(new voxblox::EsdfServer(nh, nh_private, esdf_config, esdf_integrator_config, tsdf_config,
-                                               tsdf_integrator_config, mesh_config));
+    esdf_server_.reset(new voxblox::EsdfServer(getEsdfNodeHandle(nh), getEsdfNodeHandle(nh_private), esdf_config,
+                                               esdf_integrator_config, tsdf_config, tsdf_integrator_config,
+                                               mesh_config));
     esdf_server_->setTraversabilityRadius(planner_.getSystemConstraints().collision_radius);
+    setupEsdfCallbacks();
 
     // cache constants
-    c_voxel_size_ = ssc_server_->getSSCMapPtr()->voxel_size();
-    c_block_size_ = ssc_server_->getSSCMapPtr()->block_size();
+    c_voxel_size_ = ssc_map_->voxel_size();
+    c_block_size_ = ssc_map_->block_size();
+
+    // built once here, the collision radius is fixed, so concurrent isTraversable calls only read it
+    collision_stencil_.update(planner_.getSystemConstraints().collision_radius, c_voxel_size_, collision_solid_ball_);
+
+    if (use_ssc_esdf) {
+        setupSSCEsdf(esdf_config);
+    }
+    // the frontiers are computed from the state layer
+    if (use_state_layer || use_frontier_layer) {
+        SSCPlanningStateLayer::Config state_config;
+        state_config.use_measured = use_voxblox_information_planning_;
+        state_config.use_predicted = use_ssc_information_planning_;
+        state_config.occupied_distance = c_voxel_size_;
+        state_config.occupied_log_odds = voxblox::logOddsFromProbability(0.5f);
+        setupStateLayer(state_config);
+    }
+    if (use_frontier_layer) {
+        setupFrontierLayer(frontier_config);
+    }
+
+    // after the layers derived from the ssc map, so their listeners run first and
+    // a reader never sees a new version with outdated layers
+    setupBlockVersions(state_layer_update_period);
+}
+
+ros::NodeHandle SSCVoxbloxOccupancyMap::getEsdfNodeHandle(const ros::NodeHandle& nh) {
+    ros::NodeHandle esdf_nh(nh);
+    esdf_nh.setCallbackQueue(&esdf_callback_queue_);
+    return esdf_nh;
+}
+
+void SSCVoxbloxOccupancyMap::setupEsdfCallbacks() {
+    // integration and esdf updates of the server wait for running queries and block new ones
+    constexpr double kEsdfCallbackPeriod = 0.01;
+    ros::NodeHandle nh_private("~");
+    esdf_callback_timer_ = nh_private.createWallTimer(ros::WallDuration(kEsdfCallbackPeriod),
+                                                      &SSCVoxbloxOccupancyMap::esdfCallbacksEvent, this);
+}
+
+void SSCVoxbloxOccupancyMap::esdfCallbacksEvent(const ros::WallTimerEvent& /*event*/) {
+    if (esdf_callback_queue_.isEmpty()) {
+        return;
+    }
+    voxblox::SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+    esdf_callback_queue_.callAvailable();
+}
+
+void SSCVoxbloxOccupancyMap::setupSSCEsdf(const voxblox::SSCEsdfIntegrator::Config& config) {
+    ssc_esdf_layer_.reset(new voxblox::Layer<voxblox::SSCEsdfVoxel>(ssc_map_->voxel_size(),
+                                                                    ssc_map_->getSSCLayer().voxels_per_side()));
+    ssc_esdf_integrator_.reset(new voxblox::SSCEsdfIntegrator(config, ssc_map_->getSSCLayer(), ssc_esdf_layer_.get()));
+    ssc_esdf_integrator_->updateFromSSCLayer();
+
+    // only the blocks changed by an integration are propagated
+    auto update_esdf = [this](const voxblox::SSCChangeSet& change_set) {
+        voxblox::SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+        if (change_set.map_reset) {
+            ssc_esdf_integrator_->clear();
+        }
+        ssc_esdf_integrator_->updateFromSSCBlocks(change_set.blocks);
+    };
+    if (ssc_server_) {
+        ssc_server_->addChangeListener(update_esdf);
+    } else {
+        ssc_layer_client_->addChangeListener(update_esdf);
+    }
+}
+
+void SSCVoxbloxOccupancyMap::setupBlockVersions(double update_period) {
+    auto update_versions = [this](const voxblox::SSCChangeSet& change_set) {
+        voxblox::SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+        if (change_set.map_reset) {
+            // removed blocks are not listed, everything before is outdated
+            block_versions_.clear();
+            reset_version_ = ++map_version_;
+        }
+        markBlocksChanged(change_set.blocks);
+    };
+    if (ssc_server_) {
+        ssc_server_->addChangeListener(update_versions);
+    } else {
+        ssc_layer_client_->addChangeListener(update_versions);
+    }
+
+    // the esdf server has no change notification, its updated blocks are flagged instead
+    ros::NodeHandle nh_private("~");
+    esdf_update_timer_ = nh_private.createTimer(ros::Duration(update_period),
+                                                &SSCVoxbloxOccupancyMap::updateEsdfBlocksEvent, this);
+}
+
+void SSCVoxbloxOccupancyMap::updateEsdfBlocksEvent(const ros::TimerEvent& /*event*/) {
+    voxblox::SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+    voxblox::Layer<voxblox::EsdfVoxel>* esdf_layer = esdf_server_->getEsdfMapPtr()->getEsdfLayerPtr();
+    voxblox::BlockIndexList esdf_blocks;
+    esdf_layer->getAllUpdatedBlocks(voxblox::Update::kEsdf, &esdf_blocks);
+    if (esdf_blocks.empty()) {
+        return;
+    }
+    for (const voxblox::BlockIndex& block_idx : esdf_blocks) {
+        esdf_layer->getBlockPtrByIndex(block_idx)->setUpdated(voxblox::Update::kEsdf, false);
+    }
+
+    // versions are kept per ssc block
+    const size_t ssc_voxels_per_side = ssc_map_->getSSCLayer().voxels_per_side();
+    if (esdf_layer->voxels_per_side() == ssc_voxels_per_side) {
+        markBlocksChanged(esdf_blocks);
+    } else {
+        voxblox::IndexSet ssc_blocks;
+        for (const voxblox::BlockIndex& block_idx : esdf_blocks) {
+            insertOverlappingBlocks(block_idx, esdf_layer->voxels_per_side(), ssc_voxels_per_side, &ssc_blocks);
+        }
+        markBlocksChanged(voxblox::BlockIndexList(ssc_blocks.begin(), ssc_blocks.end()));
+    }
+
+    if (state_layer_) {
+        voxblox::BlockIndexList changed_blocks;
+        state_layer_->updateFromEsdfBlocks(esdf_blocks, &changed_blocks);
+        if (frontier_layer_) {
+            frontier_layer_->updateFromStateBlocks(changed_blocks);
+        }
+    }
+}
+
+void SSCVoxbloxOccupancyMap::markBlocksChanged(const voxblox::BlockIndexList& ssc_blocks) {
+    if (ssc_blocks.empty()) {
+        return;
+    }
+    ++map_version_;
+    for (const voxblox::BlockIndex& block_idx : ssc_blocks) {
+        block_versions_[block_idx] = map_version_;
+    }
+}
+
+uint64_t SSCVoxbloxOccupancyMap::getMapVersion() {
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
+    return map_version_;
+}
+
+void SSCVoxbloxOccupancyMap::getChangedBlocks(const voxblox::BlockIndexList& blocks, uint64_t version,
+                                              bool include_neighbors, std::vector<bool>* changed) {
+    CHECK_NOTNULL(changed)->assign(blocks.size(), true);
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
+    if (version < reset_version_) {
+        return;
+    }
+    auto changed_since = [&](const voxblox::BlockIndex& block_idx) {
+        const auto it = block_versions_.find(block_idx);
+        return it != block_versions_.end() && it->second > version;
+    };
+    const int range = include_neighbors ? 1 : 0;
+    for (size_t i = 0u; i < blocks.size(); ++i) {
+        bool block_changed = false;
+        voxblox::BlockIndex offset;
+        for (offset.z() = -range; offset.z() <= range && !block_changed; ++offset.z()) {
+            for (offset.y() = -range; offset.y() <= range && !block_changed; ++offset.y()) {
+                for (offset.x() = -range; offset.x() <= range && !block_changed; ++offset.x()) {
+                    block_changed = changed_since(blocks[i] + offset);
+                }
+            }
+        }
+        (*changed)[i] = block_changed;
+    }
+}
+
+voxblox::BlockIndex SSCVoxbloxOccupancyMap::getBlockIndex(const Eigen::Vector3d& point) const {
+    return voxblox::getGridIndexFromPoint<voxblox::BlockIndex>(point.cast<voxblox::FloatingPoint>(),
+                                                               1.0 / c_block_size_);
+}
+
+void SSCVoxbloxOccupancyMap::setupStateLayer(const SSCPlanningStateLayer::Config& config) {
+    state_layer_.reset(new SSCPlanningStateLayer(config, ssc_map_->getSSCLayer(),
+                                                 esdf_server_->getEsdfMapPtr()->getEsdfLayerPtr()));
+    state_layer_->rebuild();
+
+    auto update_state = [this](const voxblox::SSCChangeSet& change_set) {
+        voxblox::SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+        if (change_set.map_reset) {
+            state_layer_->rebuild();
+            if (frontier_layer_) {
+                frontier_layer_->rebuild();
+            }
+        } else {
+            voxblox::BlockIndexList changed_blocks;
+            state_layer_->updateFromSSCBlocks(change_set.blocks, &changed_blocks);
+            if (frontier_layer_) {
+                frontier_layer_->updateFromStateBlocks(changed_blocks);
+            }
+        }
+    };
+    if (ssc_server_) {
+        ssc_server_->addChangeListener(update_state);
+    } else {
+        ssc_layer_client_->addChangeListener(update_state);
+    }
+}
+
+void SSCVoxbloxOccupancyMap::setupFrontierLayer(const SSCFrontierLayer::Config& config) {
+    CHECK(state_layer_) << "The frontier layer needs the state layer.";
+    voxblox::SSCMap::WriteLock lock = ssc_map_->lockForWriting();
+    frontier_layer_.reset(new SSCFrontierLayer(config, *state_layer_, c_voxel_size_));
+    frontier_layer_->rebuild();
+}
+
+bool SSCVoxbloxOccupancyMap::isFrontierVoxel(const Eigen::Vector3d& point) {
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
+    return frontier_layer_ && frontier_layer_->isFrontierAtPosition(point);
+}
+
+void SSCVoxbloxOccupancyMap::getFrontierVoxels(std::vector<Eigen::Vector3d>* centers) {
+    CHECK_NOTNULL(centers)->clear();
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
+    if (!frontier_layer_) {
+        return;
+    }
+    voxblox::LongIndexVector frontier_voxels;
+    frontier_layer_->getFrontierVoxels(&frontier_voxels);
+    centers->reserve(frontier_voxels.size());
+    for (const voxblox::GlobalIndex& voxel : frontier_voxels) {
+        centers->push_back(voxblox::getCenterPointFromGridIndex(voxel, c_voxel_size_).cast<double>());
+    }
+}
+
+unsigned char SSCVoxbloxOccupancyMap::getStateLayerVoxelState(const Eigen::Vector3d& point) const {
+    switch (state_layer_->getStateAtPosition(point)) {
+        case SSCPlanningStateLayer::kFree:
+            return OccupancyMap::FREE;
+        case SSCPlanningStateLayer::kOccupied:
+            return OccupancyMap::OCCUPIED;
+        default:
+            return OccupancyMap::UNKNOWN;
+    }
 }
 
 bool SSCVoxbloxOccupancyMap::isTraversable(const Eigen::Vector3d& position, const Eigen::Quaterniond& orientation) {
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
+    return isTraversableAt(position, nullptr);
+}
+
+bool SSCVoxbloxOccupancyMap::isTraversablePath(const std::vector<Eigen::Vector3d>& points) {
+    if (points.empty()) {
+        return true;
+    }
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
+    SSCVisitedVoxels visited = collision_stencil_.createVisitedVoxels(points);
+    return collision_stencil_.traversePath(points, [&](const voxblox::GlobalIndex& voxel) {
+        return isTraversableAt(collision_stencil_.getVoxelCenter(voxel), &visited);
+    });
+}
+
+bool SSCVoxbloxOccupancyMap::isTraversableAt(const Eigen::Vector3d& position, SSCVisitedVoxels* visited) {
     double collision_radius = planner_.getSystemConstraints().collision_radius;
 
     if (use_voxblox_planning_) {
@@ -80,47 +415,58 @@ bool SSCVoxbloxOccupancyMap::isTraversable(const Eigen::Vector3d& position, cons
     if (use_ssc_planning_) {
         // The voxel is not observed by voxblox tsdf map. In this case
         // check SSC Map
-        // The criteria to use ssc map is met.
-        std::vector<Eigen::Vector3d> neighbouring_points;
-        voxblox::utils::getSurroundingVoxelsSphere(position, c_voxel_size_, collision_radius, &neighbouring_points);
-
-        for (auto point : neighbouring_points) {
-            if (getVoxelState(point) == OccupancyMap::OCCUPIED) {
-                return false;
-            }
+        // The distance field only holds the predicted obstacles, so it can only replace the stencil if
+        // getVoxelState ignores the measured map. The stencil reaches voxel centers up to
+        // collision_radius + voxel size away, the distance field check keeps that band.
+        if (ssc_esdf_integrator_ && use_ssc_information_planning_ && !use_voxblox_information_planning_ &&
+            collision_radius + c_voxel_size_ < ssc_esdf_integrator_->getConfig().max_distance) {
+            return ssc_esdf_integrator_->getDistanceAtPosition(position.cast<voxblox::FloatingPoint>()) >
+                   collision_radius + c_voxel_size_;
         }
-        return true;
+        if (use_ssc_information_planning_ && !use_voxblox_information_planning_) {
+            // getVoxelState only looks at the ssc map, check the stencil on its blocks directly
+            return collision_stencil_.isCollisionFree(*ssc_map_, collision_stencil_.getGlobalIndex(position), visited);
+        }
+        return collision_stencil_.isCollisionFree(
+            collision_stencil_.getGlobalIndex(position),
+            [this](const Eigen::Vector3d& point) { return computeVoxelState(point) == OccupancyMap::OCCUPIED; },
+            visited);
     }
 
     return false;
 }
 
 bool SSCVoxbloxOccupancyMap::isObserved(const Eigen::Vector3d& point) {
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
     bool observed = false;
     if (use_voxblox_planning_) {
         observed = esdf_server_->getEsdfMapPtr()->isObserved(point);
     }
     if (use_ssc_planning_) {
-        observed = observed || ssc_server_->getSSCMapPtr()->isObserved(point);
+        observed = observed || ssc_map_->isObserved(point);
     }
     return observed;
 }
 
 double SSCVoxbloxOccupancyMap::getVoxelLogProb(const Eigen::Vector3d& point) {
-    voxblox::Point voxblox_point(point.x(), point.y(), point.z());
-    voxblox::Block<voxblox::SSCOccupancyVoxel>::Ptr block =
-        ssc_server_->getSSCMapPtr()->getSSCLayerPtr()->getBlockPtrByCoordinates(voxblox_point);
-    if (block) {
-        voxblox::SSCOccupancyVoxel* ssc_voxel = block->getVoxelPtrByCoordinates(voxblox_point);
-        if (ssc_voxel) {
-            return ssc_voxel->probability_log;
-        }
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
+    const voxblox::SSCOccupancyVoxel* ssc_voxel = ssc_map_->getVoxelPtrByCoordinates(point);
+    if (ssc_voxel) {
+        return ssc_voxel->probability_log;
     }
     return 0.0;
 }
 
 // get occupancy
 unsigned char SSCVoxbloxOccupancyMap::getVoxelState(const Eigen::Vector3d& point) {
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
+    return computeVoxelState(point);
+}
+
+unsigned char SSCVoxbloxOccupancyMap::computeVoxelState(const Eigen::Vector3d& point) {
+    if (state_layer_) {
+        return getStateLayerVoxelState(point);
+    }
     double distance = 0.0;
     if (use_voxblox_information_planning_) {
         if (esdf_server_->getEsdfMapPtr()->getDistanceAtPosition(point, &distance)) {
@@ -135,8 +481,7 @@ unsigned char SSCVoxbloxOccupancyMap::getVoxelState(const Eigen::Vector3d& point
 
     if (use_ssc_information_planning_) {
         // voxel is not observed by ESDF Map. See if its observed by SSC Map.
-        auto voxel = ssc_server_->getSSCMapPtr()->getSSCLayerPtr()->getVoxelPtrByCoordinates(
-            point.cast<voxblox::FloatingPoint>());
+        auto voxel = ssc_map_->getVoxelPtrByCoordinates(point);
 
         if (voxel == nullptr) return OccupancyMap::UNKNOWN;
 
@@ -153,14 +498,78 @@ unsigned char SSCVoxbloxOccupancyMap::getVoxelState(const Eigen::Vector3d& point
     return OccupancyMap::UNKNOWN;
 }
 
+void SSCVoxbloxOccupancyMap::getVoxelStates(const std::vector<Eigen::Vector3d>& points,
+                                            std::vector<VoxelQuery>* queries, size_t num_threads) {
+    CHECK_NOTNULL(queries);
+    queries->assign(points.size(), VoxelQuery());
+    voxblox::SSCMap::ReadLock lock = ssc_map_->lockForReading();
+
+    // measured map, the nearest voxel like the non-interpolated getDistanceAtPosition
+    const voxblox::Layer<voxblox::EsdfVoxel>& esdf_layer = esdf_server_->getEsdfMapPtr()->getEsdfLayer();
+    visitPointsByBlock(esdf_layer, points, num_threads, [&](size_t i, const voxblox::EsdfVoxel* voxel) {
+        if (voxel == nullptr || !voxel->observed) {
+            return;
+        }
+        VoxelQuery& query = (*queries)[i];
+        query.observed = true;
+        query.measured_state = voxel->distance < c_voxel_size_ ? OccupancyMap::OCCUPIED : OccupancyMap::FREE;
+    });
+
+    // predicted map, blocks whose summary has no observed voxels keep the defaults of unobserved voxels
+    const float occupied_log_odds = voxblox::logOddsFromProbability(0.5f);
+    auto unobserved_block = [this](const voxblox::BlockIndex& block_index) {
+        const voxblox::SSCBlockSummary* summary = ssc_map_->getBlockSummary(block_index);
+        return summary != nullptr && !summary->hasObserved();
+    };
+    visitPointsByBlock(ssc_map_->getSSCLayer(), points, num_threads,
+                       [&](size_t i, const voxblox::SSCOccupancyVoxel* voxel) {
+                           if (voxel == nullptr) {
+                               return;
+                           }
+                           VoxelQuery& query = (*queries)[i];
+                           query.log_prob = voxel->probability_log;
+                           if (voxel->observed) {
+                               query.predicted_state = voxel->probability_log > occupied_log_odds
+                                                           ? OccupancyMap::OCCUPIED
+                                                           : OccupancyMap::FREE;
+                           }
+                       },
+                       unobserved_block);
+
+    if (frontier_layer_) {
+        voxblox::parallelForRanges(points.size(), num_threads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                (*queries)[i].frontier = frontier_layer_->isFrontierAtPosition(points[i]);
+            }
+        });
+    }
+
+    computeQueryStates(points, queries, num_threads);
+}
+
+void SSCVoxbloxOccupancyMap::computeQueryStates(const std::vector<Eigen::Vector3d>& points,
+                                                std::vector<VoxelQuery>* queries, size_t num_threads) {
+    voxblox::parallelForRanges(points.size(), num_threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            VoxelQuery& query = (*queries)[i];
+            if (state_layer_) {
+                query.state = getStateLayerVoxelState(points[i]);
+            } else if (use_voxblox_information_planning_ && query.observed) {
+                query.state = query.measured_state;
+            } else if (use_ssc_information_planning_) {
+                query.state = query.predicted_state;
+            }
+        }
+    });
+}
+
 // get voxel size
 double SSCVoxbloxOccupancyMap::getVoxelSize() { return c_voxel_size_; }
 
 // get the center of a voxel from input point
 bool SSCVoxbloxOccupancyMap::getVoxelCenter(Eigen::Vector3d* center,
                                 const Eigen::Vector3d& point) {
-  voxblox::BlockIndex block_id = ssc_server_->getSSCMapPtr()
-                                     ->getSSCLayerPtr()
+  voxblox::BlockIndex block_id = ssc_map_->getSSCLayerPtr()
                                      ->computeBlockIndexFromCoordinates(
                                          point.cast<voxblox::FloatingPoint>());
   *center = voxblox::getOriginPointFromGridIndex(block_id, c_block_size_)
@@ -1,6 +1,8 @@
 #include "ssc_planning/trajectory_evaluator/ssc_voxel_evaluator.h"
 
 #include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <vector>
 
 namespace active_3d_planning {
@@ -21,6 +23,8 @@ void SSCVoxelEvaluator::setupFromParamMap(Module::ParamMap* param_map) {
   setParam<double>(param_map, "new_voxel_weight", &p_new_voxel_weight_, 1.0);
   setParam<double>(param_map, "voxel_log_prob_weight", &p_log_prob_weight_, 0.2);
   setParam<double>(param_map, "max_log_prob", &p_max_log_prob_, voxblox::logOddsFromProbability(0.9f));
+  setParam<int>(param_map, "query_threads", &p_query_threads_, 1);
+  setParam<bool>(param_map, "cache_gains", &p_cache_gains_, true);
 
   // setup map
   map_ = dynamic_cast<map::SSCVoxbloxOccupancyMap*>(&(planner_.getMap()));
@@ -31,14 +35,42 @@ void SSCVoxelEvaluator::setupFromParamMap(Module::ParamMap* param_map) {
 
   // cache voxblox constants
   c_voxel_size_ = map_->getVoxelSize();
+
+  // the frontier layer of the map is only used if it agrees with the frontier settings here
+  map::SSCFrontierLayer::Config frontier_config;
+  frontier_config.accurate_frontiers = p_accurate_frontiers_;
+  frontier_config.surface_frontiers = p_surface_frontiers_;
+  c_use_frontier_layer_ = map_->hasFrontierLayer(frontier_config);
+  if (map_->hasFrontierLayer() && !c_use_frontier_layer_) {
+    LOG(WARNING) << "The frontier layer of the map uses other accurate_frontiers/surface_frontiers settings than "
+                    "'SSCVoxelEvaluator', checking the frontier voxels individually.";
+  }
 }
 
 bool SSCVoxelEvaluator::storeTrajectoryInformation(
     TrajectorySegment* traj_in,
     const std::vector<Eigen::Vector3d>& new_voxels) {
-  // Uses the default voxel info, not much gain from caching more info
-  return SimulatedSensorEvaluator::storeTrajectoryInformation(traj_in,
-                                                              new_voxels);
+  if (!p_cache_gains_) {
+    // Uses the default voxel info
+    return SimulatedSensorEvaluator::storeTrajectoryInformation(traj_in,
+                                                                new_voxels);
+  }
+  SSCVoxelInfo* info = new SSCVoxelInfo();
+  info->visible_voxels = new_voxels;
+  info->voxel_gains.assign(new_voxels.size(), 0.0);
+  voxblox::AnyIndexHashMapType<size_t>::type block_ids;
+  for (size_t i = 0; i < new_voxels.size(); ++i) {
+    const voxblox::BlockIndex block_idx = map_->getBlockIndex(new_voxels[i]);
+    auto it = block_ids.find(block_idx);
+    if (it == block_ids.end()) {
+      it = block_ids.emplace(block_idx, info->blocks.size()).first;
+      info->blocks.push_back(block_idx);
+      info->block_voxels.emplace_back();
+    }
+    info->block_voxels[it->second].push_back(i);
+  }
+  traj_in->info.reset(info);
+  return true;
 }
 
 bool SSCVoxelEvaluator::computeGainFromVisibleVoxels(
@@ -47,31 +79,80 @@ bool SSCVoxelEvaluator::computeGainFromVisibleVoxels(
   if (!traj_in->info) {
     return false;
   }
+  SSCVoxelInfo* cached_info = dynamic_cast<SSCVoxelInfo*>(traj_in->info.get());
+  if (cached_info) {
+    updateVoxelGains(cached_info);
+    traj_in->gain = std::accumulate(cached_info->voxel_gains.begin(),
+                                    cached_info->voxel_gains.end(), 0.0);
+    return true;
+  }
   SimulatedSensorInfo* info =
       reinterpret_cast<SimulatedSensorInfo*>(traj_in->info.get());
 
-  // just assume we take a single image from the last trajectory point here...
-  Eigen::Vector3d origin = traj_in->trajectory.back().position_W;
+  // look up all visible voxels at once, block by block
+  std::vector<map::SSCVoxbloxOccupancyMap::VoxelQuery> queries;
+  map_->getVoxelStates(info->visible_voxels, &queries, std::max(p_query_threads_, 0));
   for (int i = 0; i < info->visible_voxels.size(); ++i) {
-    traj_in->gain += getVoxelValue(info->visible_voxels[i], origin);
+    traj_in->gain += getVoxelValue(info->visible_voxels[i], queries[i]);
   }
   return true;
 }
 
-double SSCVoxelEvaluator::getVoxelValue(const Eigen::Vector3d& voxel, const Eigen::Vector3d& origin) {
+void SSCVoxelEvaluator::updateVoxelGains(SSCVoxelInfo* info) {
+  // read before the voxels, changes in between are recomputed next time
+  const uint64_t map_version = map_->getMapVersion();
+  if (info->valid && info->map_version == map_version) {
+    return;
+  }
+
+  // frontiers depend on the neighboring voxels, possibly in other blocks
+  std::vector<size_t> voxel_ids;
+  if (!info->valid) {
+    voxel_ids.resize(info->visible_voxels.size());
+    std::iota(voxel_ids.begin(), voxel_ids.end(), size_t(0));
+  } else {
+    std::vector<bool> changed;
+    map_->getChangedBlocks(info->blocks, info->map_version,
+                           p_frontier_voxel_weight_ > 0.0, &changed);
+    for (size_t i = 0; i < info->blocks.size(); ++i) {
+      if (changed[i]) {
+        voxel_ids.insert(voxel_ids.end(), info->block_voxels[i].begin(),
+                         info->block_voxels[i].end());
+      }
+    }
+  }
+
+  if (!voxel_ids.empty()) {
+    std::vector<Eigen::Vector3d> points;
+    points.reserve(voxel_ids.size());
+    for (const size_t i : voxel_ids) {
+      points.push_back(info->visible_voxels[i]);
+    }
+    std::vector<map::SSCVoxbloxOccupancyMap::VoxelQuery> queries;
+    map_->getVoxelStates(points, &queries, std::max(p_query_threads_, 0));
+    for (size_t i = 0; i < voxel_ids.size(); ++i) {
+      info->voxel_gains[voxel_ids[i]] = getVoxelValue(points[i], queries[i]);
+    }
+  }
+  info->map_version = map_version;
+  info->valid = true;
+}
+
+double SSCVoxelEvaluator::getVoxelValue(const Eigen::Vector3d& voxel,
+                                        const map::SSCVoxbloxOccupancyMap::VoxelQuery& query) {
     // The voxel is already observed, don't consider it in calculating gain.
-    if (map_->getESDFServer().getEsdfMapPtr()->isObserved(voxel)) {
+    if (query.observed) {
         return 0;
     }
     // voxel not observed in measured map
-    unsigned char voxel_state = map_->getVoxelState(voxel);
+    unsigned char voxel_state = map_->getVoxelState(query);
     if (voxel_state != map::OccupancyMap::UNKNOWN) {
         // voxel is observed in predicted map.
         // Note:
         // map_->getVoxelState(voxel) checks in both maps but the voxel
         // is not observed in measured map, it must be either free or
         // or occupied in predicted map
-        double gain = p_log_prob_weight_ * (p_max_log_prob_ - abs(map_->getVoxelLogProb(voxel)));
+        double gain = p_log_prob_weight_ * (p_max_log_prob_ - std::abs(query.log_prob));
         gain = std::max(gain, 0.0);
         if (voxel_state == map::OccupancyMap::FREE) {
             gain += p_new_measured_voxel_weight_;
@@ -80,9 +161,10 @@ double SSCVoxelEvaluator::getVoxelValue(const Eigen::Vector3d& voxel, const Eige
             return gain;
         }
     } else {
-        // unknown voxel in both measured and predicted map
+        // unknown voxel in both measured and predicted map, the frontier layer
+        // of the map already knows whether it is a frontier
         if (p_frontier_voxel_weight_ > 0.0) {
-            if (isFrontierVoxel(voxel)) {
+            if (c_use_frontier_layer_ ? query.frontier : isFrontierVoxel(voxel)) {
                 return p_frontier_voxel_weight_;
             }
         }
@@ -104,13 +186,20 @@ void SSCVoxelEvaluator::visualizeTrajectoryValue(
   marker.scale.y() = c_voxel_size_;
   marker.scale.z() = c_voxel_size_;
 
-  // points
+  // points, the cached gains if they are kept
   double value;
-  Eigen::Vector3d origin = trajectory.trajectory.back().position_W;
   SimulatedSensorInfo* info =
       reinterpret_cast<SimulatedSensorInfo*>(trajectory.info.get());
+  SSCVoxelInfo* cached_info = dynamic_cast<SSCVoxelInfo*>(trajectory.info.get());
+  std::vector<map::SSCVoxbloxOccupancyMap::VoxelQuery> queries;
+  if (cached_info) {
+    updateVoxelGains(cached_info);
+  } else {
+    map_->getVoxelStates(info->visible_voxels, &queries, std::max(p_query_threads_, 0));
+  }
   for (int i = 0; i < info->visible_voxels.size(); ++i) {
-    value = getVoxelValue(info->visible_voxels[i], origin);
+    value = cached_info ? cached_info->voxel_gains[i]
+                        : getVoxelValue(info->visible_voxels[i], queries[i]);
     if (value > 0.0) {
       marker.points.push_back(info->visible_voxels[i]);
       Color color;